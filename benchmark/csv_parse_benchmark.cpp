@@ -0,0 +1,141 @@
+// Parse time of the three sensor_data CSV files of a sequence, loaded the way
+// MulranSequence::Load does (the three files at once) :
+//   unshared : every file splits itself over all the cores
+//   shared   : the files split one budget of cores by size (ShareCsvThreads)
+// and each file alone on one thread for reference.
+//
+//   csv_parse_benchmark [sequence folder] [--repeat n] [--threads n]
+//
+// Without a sequence folder, MulRan-sized synthetic files are written to /tmp.
+
+#include "file_player/csvparser.h"
+
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+namespace {
+
+struct ParsedTables{
+  vector<StampRow> stamps;
+  vector<GpsRow> gps;
+  vector<ImuRow> imu;
+};
+
+// about one hour of KAIST sequence : 100 Hz IMU, 10 Hz LiDAR / 4 Hz radar events, 1 Hz GPS
+void
+WriteSyntheticSequence(const string &folder)
+{
+  mkdir(folder.c_str(), 0755);
+  mkdir((folder + "/sensor_data").c_str(), 0755);
+  const int64_t start = 1561000000000000000LL;
+  const int seconds = 3600;
+
+  ofstream stamps((folder + "/sensor_data/data_stamp.csv").c_str());
+  ofstream gps((folder + "/sensor_data/gps.csv").c_str());
+  ofstream imu((folder + "/sensor_data/xsens_imu.csv").c_str());
+  stamps << setprecision(17);
+  gps << setprecision(17);
+  imu << setprecision(17);
+  for(int i = 0 ; i < seconds * 100 ; i ++){
+    int64_t stamp = start + i * 10000000LL;
+    stamps << stamp << ",imu\n";
+    if(i % 10 == 0) stamps << stamp + 1 << ",ouster\n";
+    if(i % 25 == 0) stamps << stamp + 2 << ",radar\n";
+    if(i % 100 == 0){
+      stamps << stamp + 3 << ",gps\n";
+      gps << stamp + 3 << "," << 36.37 + i * 1e-7 << "," << 127.36 + i * 1e-7 << "," << 70.5 + i * 1e-4;
+      for(int c = 0 ; c < 9 ; c ++) gps << "," << (c % 4 == 0 ? 0.0625 : 0.0);
+      gps << "\n";
+    }
+    double t = i * 0.01;
+    imu << stamp << "," << 0.001 * t << "," << -0.002 * t << "," << 0.7071067811865476 << "," << 0.7071067811865475
+        << "," << 0.01 * t << "," << -0.02 * t << "," << 1.5707963267948966
+        << "," << 0.0012 << "," << -0.0034 << "," << 0.0056
+        << "," << 0.123 << "," << -0.456 << "," << 9.80665
+        << "," << 0.31 << "," << -0.12 << "," << 0.44 << "\n";
+  }
+}
+
+double
+Seconds(chrono::steady_clock::time_point start)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// the three files at once, the GPS and IMU files on their own threads as in MulranSequence::Load
+double
+ParseConcurrently(const vector<string> &paths, const vector<int> &threads, ParsedTables &tables)
+{
+  auto start = chrono::steady_clock::now();
+  thread gps_parser([&]{ ParseGpsCsv(paths[1], tables.gps, threads[1]); });
+  thread imu_parser([&]{ ParseImuCsv(paths[2], tables.imu, threads[2]); });
+  ParseDataStampCsv(paths[0], tables.stamps, threads[0]);
+  gps_parser.join();
+  imu_parser.join();
+  return Seconds(start);
+}
+
+double
+ParseSequentially(const vector<string> &paths, ParsedTables &tables)
+{
+  auto start = chrono::steady_clock::now();
+  ParseDataStampCsv(paths[0], tables.stamps, 1);
+  ParseGpsCsv(paths[1], tables.gps, 1);
+  ParseImuCsv(paths[2], tables.imu, 1);
+  return Seconds(start);
+}
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+  string folder;
+  int repeat = 5;
+  int cores = max(1u, thread::hardware_concurrency());
+  for(int i = 1 ; i < argc ; i ++){
+    string arg = argv[i];
+    if(arg == "--repeat" && i + 1 < argc) repeat = max(1, atoi(argv[++i]));
+    else if(arg == "--threads" && i + 1 < argc) cores = max(1, atoi(argv[++i]));
+    else folder = arg;
+  }
+  if(folder.empty()){
+    folder = "/tmp/csv_parse_benchmark";
+    cout << "Writing a synthetic sequence to " << folder << endl;
+    WriteSyntheticSequence(folder);
+  }
+
+  vector<string> paths;
+  paths.push_back(folder + "/sensor_data/data_stamp.csv");
+  paths.push_back(folder + "/sensor_data/gps.csv");
+  paths.push_back(folder + "/sensor_data/xsens_imu.csv");
+  vector<int> unshared(paths.size(), cores);
+  vector<int> shared = ShareCsvThreads(paths, cores);
+
+  double best_sequential = 1e30, best_unshared = 1e30, best_shared = 1e30;
+  ParsedTables tables;
+  for(int r = 0 ; r < repeat ; r ++){
+    best_sequential = min(best_sequential, ParseSequentially(paths, tables));
+    best_unshared = min(best_unshared, ParseConcurrently(paths, unshared, tables));
+    best_shared = min(best_shared, ParseConcurrently(paths, shared, tables));
+  }
+
+  cout << tables.stamps.size() << " events, " << tables.gps.size() << " GPS fixes, "
+       << tables.imu.size() << " IMU samples, best of " << repeat << endl;
+  cout << "sequential, one thread each : " << best_sequential * 1e3 << " ms" << endl;
+  cout << "unshared, " << cores << " threads per file : " << best_unshared * 1e3 << " ms ("
+       << cores * static_cast<int>(paths.size()) << " threads)" << endl;
+  cout << "shared, " << shared[0] << " / " << shared[1] << " / " << shared[2] << " threads : "
+       << best_shared * 1e3 << " ms (" << shared[0] + shared[1] + shared[2] << " threads)" << endl;
+  return 0;
+}
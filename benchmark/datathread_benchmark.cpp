@@ -0,0 +1,157 @@
+// Hand-off cost of the per-sensor publisher queues : the lock-free SPSC ring of DataThread
+// against the mutex + condition_variable std::queue it replaced. One producer pushes stamps
+// in bursts (like IMU samples around a LiDAR scan), one consumer waits and drains them the
+// way the publisher threads do. Reported : messages per second and push-to-pop latency.
+//
+//   datathread_benchmark [--messages n] [--burst n] [--gap-us n]
+
+#include "file_player/datathread.h"
+
+#include <queue>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+#include <stdlib.h>
+
+using namespace std;
+
+namespace {
+
+typedef chrono::steady_clock Clock;
+
+int64_t
+NowNs()
+{
+  return chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// the former DataThread : producer pushes under the mutex and notifies, consumer waits on cv_
+struct MutexQueue{
+  mutex mutex_;
+  queue<int64_t> data_queue_;
+  condition_variable cv_;
+  atomic<bool> active_;
+
+  MutexQueue() : active_(true){}
+
+  bool push(const int64_t &data){
+    {
+      lock_guard<mutex> lg(mutex_);
+      data_queue_.push(data);
+    }
+    cv_.notify_all();
+    return true;
+  }
+
+  bool pop(int64_t &data){
+    lock_guard<mutex> lg(mutex_);
+    if(data_queue_.empty()) return false;
+    data = data_queue_.front();
+    data_queue_.pop();
+    return true;
+  }
+
+  void wait(){
+    unique_lock<mutex> ul(mutex_);
+    cv_.wait(ul, [&]{ return !data_queue_.empty() || !active_; });
+  }
+
+  void stop(){
+    {
+      lock_guard<mutex> lg(mutex_);
+      active_ = false;
+    }
+    cv_.notify_all();
+  }
+
+  bool active() const { return active_; }
+};
+
+struct RingQueue{
+  DataThread<int64_t> thread_;
+
+  bool push(const int64_t &data){ return thread_.push(data); }
+  bool pop(int64_t &data){ return thread_.pop(data); }
+  void wait(){ thread_.wait(); }
+  void stop(){ thread_.stop(); }
+  bool active() const { return thread_.active_; }
+};
+
+struct Result{
+  double seconds;
+  vector<int64_t> latencies;
+};
+
+// every message carries its push time, the consumer records push-to-pop latency
+template <typename Queue>
+Result
+Run(Queue &queue, size_t messages, size_t burst, int gap_us)
+{
+  Result result;
+  result.latencies.reserve(messages);
+  thread consumer([&]{
+    int64_t stamp;
+    while(1){
+      queue.wait();
+      while(queue.pop(stamp)) result.latencies.push_back(NowNs() - stamp);
+      if(!queue.active() && result.latencies.size() == messages) return;
+    }
+  });
+
+  Clock::time_point start = Clock::now();
+  for(size_t sent = 0 ; sent < messages ; ){
+    for(size_t i = 0 ; i < burst && sent < messages ; i ++, sent ++){
+      while(!queue.push(NowNs())) this_thread::yield();
+    }
+    if(gap_us > 0) this_thread::sleep_for(chrono::microseconds(gap_us));
+  }
+  queue.stop();
+  consumer.join();
+  result.seconds = chrono::duration<double>(Clock::now() - start).count();
+  return result;
+}
+
+void
+Report(const char *name, Result &result)
+{
+  vector<int64_t> &l = result.latencies;
+  sort(l.begin(), l.end());
+  cout << name << " : " << l.size() / result.seconds / 1e6 << " M msg/s, latency p50 "
+       << l[l.size() / 2] / 1000.0 << " us, p99 " << l[l.size() * 99 / 100] / 1000.0 << " us, max "
+       << l.back() / 1000.0 << " us" << endl;
+}
+
+} // namespace
+
+
+int
+main(int argc, char **argv)
+{
+  size_t messages = 1000000;
+  size_t burst = 10;
+  int gap_us = 0;
+  for(int i = 1 ; i + 1 < argc ; i += 2){
+    string arg = argv[i];
+    if(arg == "--messages") messages = max(1, atoi(argv[i + 1]));
+    else if(arg == "--burst") burst = max(1, atoi(argv[i + 1]));
+    else if(arg == "--gap-us") gap_us = max(0, atoi(argv[i + 1]));
+  }
+  cout << messages << " messages in bursts of " << burst << ", " << gap_us << " us apart" << endl;
+
+  // the ring is large, keep it off the stack
+  RingQueue *ring = new RingQueue;
+  Result ring_result = Run(*ring, messages, burst, gap_us);
+  delete ring;
+  Report("SPSC ring  ", ring_result);
+
+  MutexQueue mutex_queue;
+  Result mutex_result = Run(mutex_queue, messages, burst, gap_us);
+  Report("mutex queue", mutex_result);
+  return 0;
+}
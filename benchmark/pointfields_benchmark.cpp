@@ -0,0 +1,60 @@
+// Throughput of the point-field synthesis kernels (scalar, SSE2, AVX2) over OS1-64 scans :
+// copy x y z intensity from the .bin bytes and fill ring and t.
+//
+//   pointfields_benchmark [--columns n] [--scans n]
+
+#include "file_player/pointfields.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+int
+main(int argc, char **argv)
+{
+  size_t columns = 1024;  // OS1-64 at 10 Hz
+  int scans = 2000;
+  for(int i = 1 ; i + 1 < argc ; i += 2){
+    string arg = argv[i];
+    if(arg == "--columns") columns = max(1, atoi(argv[i + 1]));
+    else if(arg == "--scans") scans = max(1, atoi(argv[i + 1]));
+  }
+  const char *names[NUM_POINT_FIELDS_KERNELS] = {"scalar", "sse2  ", "avx2  "};
+  const size_t num_points = columns * OUSTER_CHANNELS;
+
+  vector<uint8_t> bin(num_points * OUSTER_BIN_POINT_SIZE);
+  for(size_t i = 0 ; i < bin.size() ; i ++) bin[i] = static_cast<uint8_t>(i * 131 + 7);
+  vector<OusterPoint> points(num_points);
+  vector<OusterPoint> reference(num_points);
+  WriteOusterPointsWith(POINT_FIELDS_SCALAR, bin.data(), reference.data(), num_points, 100000000);
+
+  cout << scans << " scans of " << num_points << " points, WriteOusterPoints runs "
+       << names[BestPointFieldsKernel()] << endl;
+  for(int k = 0 ; k < NUM_POINT_FIELDS_KERNELS ; k ++){
+    PointFieldsKernel kernel = static_cast<PointFieldsKernel>(k);
+    if(!PointFieldsKernelSupported(kernel)){
+      cout << names[k] << " : not supported here" << endl;
+      continue;
+    }
+    WriteOusterPointsWith(kernel, bin.data(), points.data(), num_points, 100000000);  // warm up
+    double best = 1e30;
+    for(int round = 0 ; round < 5 ; round ++){
+      auto start = chrono::steady_clock::now();
+      for(int s = 0 ; s < scans / 5 + 1 ; s ++)
+        WriteOusterPointsWith(kernel, bin.data(), points.data(), num_points, 100000000 + s % 2);
+      best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count() / (scans / 5 + 1));
+    }
+    WriteOusterPointsWith(kernel, bin.data(), points.data(), num_points, 100000000);
+    bool same = memcmp(points.data(), reference.data(), num_points * sizeof(OusterPoint)) == 0;
+    cout << names[k] << " : " << best * 1e6 << " us per scan, " << num_points / best / 1e6 << " M points/s, "
+         << (bin.size() + num_points * sizeof(OusterPoint)) / best / (1 << 30) << " GB/s"
+         << (same ? "" : " (OUTPUT DIFFERS FROM SCALAR)") << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+#ifndef BAGEXPORTER_H
+#define BAGEXPORTER_H
+
+#include <string>
+#include <vector>
+#include <limits>
+#include <stdint.h>
+
+#include "file_player/sequence.h"
+#include "file_player/ousterdecoder.h"
+#include "file_player/cloudreduction.h"
+#include "file_player/pointlayout.h"
+
+struct ExportOptions{
+
+  ExportOptions()
+    : imu(true), gps(false), ouster(true), ouster_reduced(false), radar(false),
+      start_stamp(0), end_stamp(std::numeric_limits<int64_t>::max()),
+      threads(1), memory_bytes(static_cast<size_t>(1024) << 20),
+      ouster_scan_period_ns(OUSTER_SCAN_PERIOD_NS),
+      point_layout(POINT_LAYOUT_FULL), point_scale(0.005f),
+      split_duration(0), split_bytes(0), split_overlap(1000000000LL), split_writers(2),
+      checkpoint_period(60.0), resume(true){}
+
+  std::string output_path;
+
+  // topics to write
+  bool imu;
+  bool gps;
+  bool ouster;
+  bool ouster_reduced;  // /os1_points_reduced, see reduction
+  bool radar;   // radar polar PNGs, written as they are on /radar/polar/compressed
+
+  // only messages with start_stamp <= stamp <= end_stamp [ns] are written
+  int64_t start_stamp;
+  int64_t end_stamp;
+
+  // LiDAR decode threads and cap of the scans being decoded or waiting in the reorder buffer
+  int threads;
+  size_t memory_bytes;
+
+  // LiDAR rotation period the per-point t field is spread over
+  uint32_t ouster_scan_period_ns;
+
+  // stages of /os1_points_reduced, applied by the decode threads
+  ReductionOptions reduction;
+
+  // wire layout of both LiDAR topics (see pointlayout.h), scale is the xyz16 step [m]
+  PointLayout point_layout;
+  float point_scale;
+
+  // Split the export into <output>_000.bag, <output>_001.bag, ... : a new bag starts once
+  // split_duration [ns] of data or about split_bytes of message payload (estimated from the
+  // file sizes before writing) is in the current one, 0 turns a criterion off.
+  // IMU samples within split_overlap [ns] of a boundary go into both bags, so preintegration
+  // runs on across it. split_writers bags are written at once, each by its own thread with
+  // an equal share of threads and memory_bytes.
+  int64_t split_duration;
+  uint64_t split_bytes;
+  int64_t split_overlap;
+  int split_writers;
+
+  // Every checkpoint_period s (wall time) the bag being written is closed and goes on in a
+  // continuation split (<bag>, <stem>_001.bag, ...), 0 writes every bag in one piece.
+  // With resume, an interrupted export keeps the segments it closed and goes on after them,
+  // and an unchanged finished export is skipped (see exportcheckpoint.h); without it
+  // everything is written again.
+  double checkpoint_period;
+  bool resume;
+
+};
+
+// Stamps [first, last] of one bag, and the wider IMU window around them
+struct ExportRange{
+  int64_t first;
+  int64_t last;
+  int64_t imu_first;
+  int64_t imu_last;
+  std::string path;
+};
+
+// Bag holding split of a split export of output_path (<stem>_<split>.bag)
+std::string SplitBagPath(const std::string &output_path, size_t split);
+
+// Cut [first, last] of sequence into the bags of a split export (see ExportOptions), a
+// single range of all of it when neither split criterion is set
+std::vector<ExportRange> PlanSplits(const MulranSequence &sequence, const ExportOptions &options, int64_t first, int64_t last);
+
+// Write the selected topics of sequence into options.output_path (or its splits), merged in stamp order
+bool ExportBag(const MulranSequence &sequence, const ExportOptions &options);
+
+#endif // BAGEXPORTER_H
@@ -0,0 +1,78 @@
+#ifndef CLOUDREDUCTION_H
+#define CLOUDREDUCTION_H
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "file_player/ousterdecoder.h"
+
+// Reduced copy of a decoded Ouster scan (OusterPoint layout, column-major as written by
+// LoadOusterScan) for consumers that do not need every point. Stages, in order:
+//   ring / column decimation : keep beams 0, n, 2n ... and firing columns 0, m, 2m ...
+//   range crop               : min_range <= |p| <= max_range
+//   box crop                 : box_min <= p <= box_max (sensor frame)
+//   voxel grid               : one point per occupied voxel, the centroid of x, y, z and
+//                              intensity with the t and ring of the first point in it
+// A stage is off at its default value.
+struct ReductionOptions{
+
+  ReductionOptions()
+    : ring_step(1), column_step(1), min_range(0.0f), max_range(0.0f), use_box(false),
+      voxel_size(0.0f), threads(1){
+    for(int i = 0 ; i < 3 ; i ++){
+      box_min[i] = 0.0f;
+      box_max[i] = 0.0f;
+    }
+  }
+
+  int ring_step;
+  int column_step;
+  float min_range;   // [m], 0 keeps everything close
+  float max_range;   // [m], 0 keeps everything far
+  bool use_box;
+  float box_min[3];
+  float box_max[3];
+  float voxel_size;  // [m], 0 keeps every point
+
+  // threads the points of one scan are split over (the calling thread is one of them), small
+  // scans use fewer of them or stay on the calling thread
+  int threads;
+
+};
+
+class ReductionWorkers;
+
+// Buffers and worker threads reused from one scan to the next, one per thread calling ReduceCloud
+struct ReductionScratch{
+
+  ReductionScratch();
+  ~ReductionScratch();
+
+  struct VoxelSum{
+    float x, y, z, intensity;
+    uint32_t count;
+    uint32_t first;  // index of the first point in the voxel
+  };
+
+  struct Part{
+    std::vector<uint32_t> kept;     // indices of the points passing decimation and crops
+    std::vector<uint64_t> keys;     // their hashed voxel keys
+    std::vector<int32_t> table;     // open addressing key -> sums index
+    std::vector<uint64_t> table_keys;
+    std::vector<VoxelSum> sums;
+  };
+
+  std::vector<Part> parts;
+
+  // started by the first scan that is split over threads, kept for the next ones
+  std::unique_ptr<ReductionWorkers> workers;
+
+};
+
+// Reduce in into out (same fields), returns the number of points kept
+size_t ReduceCloud(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out,
+                   const ReductionOptions &options, ReductionScratch &scratch);
+
+#endif // CLOUDREDUCTION_H
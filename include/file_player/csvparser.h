@@ -0,0 +1,80 @@
+#ifndef CSVPARSER_H
+#define CSVPARSER_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+// Streaming parser of the MulRan sensor_data CSV files.
+// The file is mapped once, split into chunks at line boundaries, and the chunks are parsed
+// on separate threads with locale-independent, allocation-free number parsing. Like the
+// former fscanf loops, parsing stops at the first malformed line.
+
+// Read-only view of a whole file (mmap, or one bulk read when mapping is not possible)
+class MappedFile{
+
+public:
+  MappedFile() : data_(NULL), size_(0), mapped_(false){}
+  ~MappedFile(){ Close(); }
+
+  bool Open(const std::string &path);
+  void Close();
+
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  const char *data_;
+  size_t size_;
+  bool mapped_;
+  std::vector<char> buffer_;
+};
+
+
+// Number parsers : parse at p (leading blanks skipped), return the position after the number
+// or NULL when there is no number. They never read at or past end.
+const char *ParseInt64(const char *p, const char *end, int64_t &value);
+const char *ParseDouble(const char *p, const char *end, double &value);
+
+
+// data_stamp.csv : <stamp>,<sensor name>
+struct StampRow{
+  int64_t stamp;
+  std::string name;
+};
+
+// gps.csv : stamp, latitude, longitude, altitude, 9 position covariance
+struct GpsRow{
+  int64_t stamp;
+  double latitude;
+  double longitude;
+  double altitude;
+  double cov[9];
+};
+
+// xsens_imu.csv : stamp, quaternion x y z w, euler x y z [, gyro x y z, acc x y z, mag x y z]
+// fields is 8 for orientation-only files and 17 for full ones
+struct ImuRow{
+  int64_t stamp;
+  int fields;
+  double q[4];
+  double euler[3];
+  double gyro[3];
+  double acc[3];
+  double mag[3];
+};
+
+// Each returns false when the file can not be read. num_threads 0 means one per core.
+bool ParseDataStampCsv(const std::string &path, std::vector<StampRow> &rows, int num_threads = 0);
+bool ParseGpsCsv(const std::string &path, std::vector<GpsRow> &rows, int num_threads = 0);
+bool ParseImuCsv(const std::string &path, std::vector<ImuRow> &rows, int num_threads = 0);
+
+// Share one budget of num_threads (0 : one per core) between files parsed at the same time,
+// in proportion to their sizes. Every file gets at least one thread, missing files count as empty.
+std::vector<int> ShareCsvThreads(const std::vector<std::string> &paths, int num_threads = 0);
+
+#endif // CSVPARSER_H
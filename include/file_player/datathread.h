@@ -1,55 +1,111 @@
 #ifndef DATATHREAD_H
 #define DATATHREAD_H
 
-#include <mutex>
-#include <ctime>
+#include <atomic>
 #include <thread>
-#include <condition_variable>
+#include <climits>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
-template <typename T>
+#define DATATHREAD_SPIN 64
+
+// Publisher thread of one sensor, fed through a bounded single-producer / single-consumer
+// lock-free ring. The producer (the data stamp dispatcher) push()es, the consumer thread
+// wait()s and then drains it with pop(). The consumer only sleeps in the kernel (futex) and
+// the producer only makes a syscall when the consumer is actually asleep, so a push that
+// races with the consumer going to sleep is never lost.
+// T is the queued payload, e.g. a stamp or an event holding a handle of the data to publish.
+template <typename T, size_t Capacity = 4096>
 struct DataThread{
 
-  std::mutex mutex_;
-  std::queue<T> data_queue_;
-  std::condition_variable cv_;
+  static_assert((Capacity & (Capacity - 1)) == 0, "DataThread capacity must be a power of two");
+
   std::thread thread_;
-  bool active_;
+  std::atomic<bool> active_;
+
+  DataThread() : active_(true), head_(0), tail_cache_(0), tail_(0), head_cache_(0), signal_(0), sleeping_(0){}
+
+  // producer : false when the ring is full
+  bool push(const T &data){
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if(tail - head_cache_ == Capacity){
+      head_cache_ = head_.load(std::memory_order_acquire);
+      if(tail - head_cache_ == Capacity) return false;
+    }
+    ring_[tail & (Capacity - 1)] = data;
+    tail_.store(tail + 1, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleeping_.load(std::memory_order_relaxed)) Wake();
+    return true;
+  }
 
-  DataThread() : active_(true){}
+  // consumer : false when the ring is empty
+  bool pop(T &data){
+    size_t head = head_.load(std::memory_order_relaxed);
+    if(head == tail_cache_){
+      tail_cache_ = tail_.load(std::memory_order_acquire);
+      if(head == tail_cache_) return false;
+    }
+    data = ring_[head & (Capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
 
-  void push(T data){
-    mutex_.lock();
-    data_queue_.push(data);
-    mutex_.unlock();
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
   }
 
-  T pop(){
-    T result;
-    mutex_.lock();
-    result = data_queue_.front();
-    data_queue_.pop();
-    mutex_.unlock();
-    return result;
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
   }
 
-//  virtual void DataProcess(T data){
+  // consumer : block until there is data or stop() was called
+  void wait(){
+    // bursts (e.g. IMU samples) usually arrive within a few microseconds, catch them before sleeping
+    for(int i = 0 ; i < DATATHREAD_SPIN ; i ++){
+      if(!empty() || !active_) return;
+      std::this_thread::yield();
+    }
+    while(1){
+      uint32_t signal = signal_.load(std::memory_order_acquire);
+      sleeping_.store(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if(!empty() || !active_){
+        sleeping_.store(0, std::memory_order_relaxed);
+        return;
+      }
+      // returns at once when signal_ moved on since it was read
+      syscall(SYS_futex, reinterpret_cast<uint32_t *>(&signal_), FUTEX_WAIT_PRIVATE, signal, NULL, NULL, 0);
+      sleeping_.store(0, std::memory_order_relaxed);
+    }
+  }
 
-//  }
+  // end wait() for good, the consumer returns once it sees active_ false
+  void stop(){
+    active_ = false;
+    Wake();
+  }
 
-//  void DataProcessThread(){
-//    while(1){
-//      std::unique_lock<std::mutex> ul(mutex_);
-//      cv_.wait(ul);
-//      if(active_ == false) return;
-//      ul.unlock();
+private:
+  void Wake(){
+    signal_.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&signal_), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+  }
 
-//      while(!data_queue_.empty()){
-//        auto data = pop();
-//        //process
-//        DataProcess(data);
-//      }
-//    }
-//  }
+  // each side's index and its cached copy of the other side's index share a cache line
+  std::atomic<size_t> head_;      // written by the consumer
+  size_t tail_cache_;             // consumer's view of tail_
+  char head_pad_[64];
+  std::atomic<size_t> tail_;      // written by the producer
+  size_t head_cache_;             // producer's view of head_
+  char tail_pad_[64];
+  std::atomic<uint32_t> signal_;  // futex word, bumped by every wake
+  std::atomic<uint32_t> sleeping_;
+  char signal_pad_[64];
+  T ring_[Capacity];
 
 };
 
@@ -0,0 +1,100 @@
+#ifndef EVENTSCHEDULER_H
+#define EVENTSCHEDULER_H
+
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <iostream>
+#include <condition_variable>
+#include <stdint.h>
+#include <time.h>
+
+// Sleeps the event dispatcher until the wall-clock deadline of its next event.
+// Every control change (play, pause, seek, rate, shutdown) calls Wake(), which ends the
+// current wait at once so the dispatcher recomputes its deadline. A caller takes
+// Generation() before it reads the control state it bases the wait on, so a Wake() in
+// between is never lost.
+// The timing statistics are only touched by the dispatching thread.
+class EventScheduler{
+
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  EventScheduler() : generation_(0){ ResetStats(); }
+
+  uint64_t Generation(){
+    std::lock_guard<std::mutex> lg(mutex_);
+    return generation_;
+  }
+
+  // false when woken (or already woken since generation) before the deadline
+  bool WaitUntil(uint64_t generation, Clock::time_point deadline){
+    std::unique_lock<std::mutex> ul(mutex_);
+    wakeups_++;
+    return !cv_.wait_until(ul, deadline, [&]{ return generation_ != generation; });
+  }
+
+  // until the next Wake() since generation
+  void Wait(uint64_t generation){
+    std::unique_lock<std::mutex> ul(mutex_);
+    wakeups_++;
+    cv_.wait(ul, [&]{ return generation_ != generation; });
+  }
+
+  void Wake(){
+    {
+      std::lock_guard<std::mutex> lg(mutex_);
+      generation_++;
+    }
+    cv_.notify_all();
+  }
+
+  // timing error of one dispatched event : how late (ns) it left the dispatcher
+  void Record(int64_t lateness_ns){
+    if(lateness_ns < 0) lateness_ns = 0;
+    events_++;
+    lateness_sum_ += lateness_ns;
+    if(lateness_ns > lateness_max_) lateness_max_ = lateness_ns;
+    if(lateness_ns > 1000000) late_1ms_++;
+  }
+
+  void ResetStats(){
+    events_ = 0;
+    wakeups_ = 0;
+    lateness_sum_ = 0;
+    lateness_max_ = 0;
+    late_1ms_ = 0;
+    cpu_start_ns_ = ThreadCpuNs();
+  }
+
+  // call from the dispatching thread, cpu time is the one of the calling thread
+  void PrintReport(const std::string &name) const {
+    if(events_ == 0) return;
+    std::cout << name << " timing : " << events_ << " events, "
+              << "mean lateness " << lateness_sum_ / events_ / 1000.0 << " us, "
+              << "max " << lateness_max_ / 1000.0 << " us, "
+              << late_1ms_ << " over 1 ms, "
+              << wakeups_ << " sleeps, "
+              << (ThreadCpuNs() - cpu_start_ns_) / 1e6 << " ms cpu" << std::endl;
+  }
+
+private:
+  static int64_t ThreadCpuNs(){
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec)*1000000000LL + ts.tv_nsec;
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  uint64_t generation_;
+
+  uint64_t events_;
+  uint64_t wakeups_;
+  int64_t lateness_sum_;
+  int64_t lateness_max_;
+  uint64_t late_1ms_;
+  int64_t cpu_start_ns_;
+};
+
+#endif // EVENTSCHEDULER_H
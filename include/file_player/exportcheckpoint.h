@@ -0,0 +1,63 @@
+#ifndef EXPORTCHECKPOINT_H
+#define EXPORTCHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+// Resumable bag export.
+// A bag is written in segments : every checkpoint period the segment being written is closed,
+// the export goes on in a continuation split (<bag>, <stem>_001.bag, <stem>_002.bag, ...) and
+// <bag>.checkpoint records what the bag is written from (source digest and options, stamp
+// range), the size of every closed segment and the last stamp written of each topic up to it.
+// A re-run keeps the closed segments, drops the one that was being written and goes on from
+// those stamps in the next continuation split, so an interruption loses at most one checkpoint
+// period of work, also for a single unsplit bag. A finished bag is marked complete and kept.
+// Once every bag of an export is complete, <output>.manifest lists them with their sizes;
+// a re-run with the same source and options finds it and writes nothing. The checkpoints
+// are kept next to it, so a bag lost later is the only one written again.
+#define EXPORT_CHECKPOINT_SUFFIX ".checkpoint"
+#define EXPORT_MANIFEST_SUFFIX ".manifest"
+
+enum ExportTopic { EXPORT_IMU, EXPORT_GPS, EXPORT_OUSTER, EXPORT_RADAR, NUM_EXPORT_TOPICS };
+
+struct ExportSegment{
+  uint64_t size;                          // size of the closed segment bag
+  int64_t last_stamp[NUM_EXPORT_TOPICS];  // last row of each topic written up to its end, -1 none yet
+};
+
+struct ExportCheckpoint{
+  std::string key;       // source digest and export options the bag is written from
+  int64_t first;         // stamp range of the bag
+  int64_t last;
+  bool complete;         // the last segment ends the range
+  std::vector<ExportSegment> segments;  // closed segments, in order
+};
+
+// Bag holding segment of the bag at bag_path : bag_path itself, then its continuation splits
+std::string ExportSegmentPath(const std::string &bag_path, size_t segment);
+
+bool SaveExportCheckpoint(const std::string &bag_path, const ExportCheckpoint &checkpoint);
+
+// false when there is no readable checkpoint of bag_path
+bool LoadExportCheckpoint(const std::string &bag_path, ExportCheckpoint &checkpoint);
+
+// every closed segment of checkpoint is there with its recorded size
+bool ExportCheckpointValid(const std::string &bag_path, const ExportCheckpoint &checkpoint);
+
+void RemoveExportCheckpoint(const std::string &bag_path);
+
+struct ExportManifest{
+  std::string key;
+  std::vector<std::pair<std::string, uint64_t> > bags;  // path, size
+};
+
+bool SaveExportManifest(const std::string &output_path, const ExportManifest &manifest);
+bool LoadExportManifest(const std::string &output_path, ExportManifest &manifest);
+void RemoveExportManifest(const std::string &output_path);
+
+// every bag of manifest is there with its recorded size
+bool ExportManifestValid(const ExportManifest &manifest);
+
+#endif // EXPORTCHECKPOINT_H
@@ -0,0 +1,50 @@
+#ifndef EXPORTSTREAM_H
+#define EXPORTSTREAM_H
+
+#include <queue>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <stdint.h>
+#include <rosbag/bag.h>
+
+// One time-sorted source of bag messages (one sensor topic)
+struct ExportStream{
+
+  virtual ~ExportStream(){}
+
+  // stamp of the message Write() writes next, false once the stream is exhausted
+  virtual bool Peek(int64_t &stamp) = 0;
+
+  // write the current message and advance
+  virtual void Write(rosbag::Bag &bag) = 0;
+
+};
+
+// k-way merge of the streams into bag, so messages land in the bag in global stamp order.
+// On equal stamps the stream listed first is written first. stop, when given, is asked after
+// every message : once it says so the merge returns, the streams stay at the next message
+// and a later merge goes on from there.
+inline size_t
+MergeStreams(const std::vector<ExportStream *> &streams, rosbag::Bag &bag,
+             const std::function<bool()> &stop = std::function<bool()>())
+{
+  typedef std::pair<int64_t, size_t> Head;
+  std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+  int64_t stamp;
+  for(size_t i = 0 ; i < streams.size() ; i ++)
+    if(streams[i]->Peek(stamp)) heads.push(Head(stamp, i));
+
+  size_t count = 0;
+  while(!heads.empty()){
+    size_t i = heads.top().second;
+    heads.pop();
+    streams[i]->Write(bag);
+    count++;
+    if(stop && stop()) break;
+    if(streams[i]->Peek(stamp)) heads.push(Head(stamp, i));
+  }
+  return count;
+}
+
+#endif // EXPORTSTREAM_H
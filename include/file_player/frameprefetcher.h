@@ -0,0 +1,209 @@
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <utility>
+#include <iostream>
+#include <functional>
+#include <condition_variable>
+
+// Bounded read-ahead of decoded frames.
+// Frames are addressed by their index in a file list. Background loader threads keep up to
+// depth frames (and at most byte_budget bytes) decoded ahead of the playback cursor, which
+// is moved by every Get(). Frame objects are recycled (up to depth of them are kept), so
+// loaders decode into buffers that were already allocated by earlier frames. A frame being
+// loaded counts against the budget with the size of the last loaded frame until its real
+// size is known. A Get() waiting on a slot pins it, so neither a Seek() nor a loader
+// releases it under the waiter.
+template <typename T>
+class FramePrefetcher{
+
+public:
+  typedef std::function<bool(size_t index, T &frame)> Loader;
+  typedef std::function<size_t(const T &frame)> SizeOf;
+
+  FramePrefetcher(const std::string &name) : name_(name), estimate_(0), waiters_(0), active_(false), hits_(0), misses_(0){}
+  ~FramePrefetcher(){ Stop(); }
+
+  void Start(size_t count, Loader loader, SizeOf size_of, size_t depth, size_t byte_budget, int num_threads){
+    Stop();
+    count_ = count;
+    loader_ = loader;
+    size_of_ = size_of;
+    depth_ = depth;
+    byte_budget_ = byte_budget;
+    cursor_ = 0;
+    bytes_ = 0;
+    estimate_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+    active_ = true;
+    if(depth_ == 0) return;
+    for(int i = 0 ; i < num_threads ; i ++)
+      threads_.push_back(std::thread(&FramePrefetcher::LoaderThread, this));
+  }
+
+  void Stop(){
+    {
+      std::lock_guard<std::mutex> lg(mutex_);
+      if(active_ == false) return;
+      active_ = false;
+    }
+    cv_.notify_all();
+    for(auto &th : threads_) if(th.joinable()) th.join();
+    threads_.clear();
+    std::unique_lock<std::mutex> ul(mutex_);
+    cv_.wait(ul, [&]{ return waiters_ == 0; });  // no slot is loading any more, they leave at once
+    slots_.clear();
+    free_frames_.clear();
+    bytes_ = 0;
+    std::cout << name_ << " read-ahead : " << hits_ << " hits, " << misses_ << " misses" << std::endl;
+  }
+
+  // Hand out the frame at index (swapped into frame) and move the cursor behind it.
+  // Loads synchronously when the frame is not in the read-ahead window.
+  bool Get(size_t index, T &frame){
+    std::unique_lock<std::mutex> ul(mutex_);
+    cursor_ = index + 1;
+    Trim(index);
+    auto iter = slots_.find(index);
+    if(iter != slots_.end()){
+      iter->second.waiters++;
+      waiters_++;
+      cv_.wait(ul, [&]{ return iter->second.state != LOADING; });
+      iter->second.waiters--;
+      waiters_--;
+      bool ok = (iter->second.state == READY);
+      if(ok) std::swap(frame, iter->second.frame);
+      if(iter->second.waiters == 0) Release(iter);
+      else iter->second.state = FAILED;  // the frame is taken, another Get() of it gets nothing
+      ul.unlock();
+      cv_.notify_all();
+      if(ok) hits_++;
+      else misses_++;  // the read-ahead failed on it too
+      return ok;
+    }
+    ul.unlock();
+    cv_.notify_all();
+    misses_++;
+    return loader_(index, frame);
+  }
+
+  // Move the cursor to index without handing out a frame (seek) : finished frames outside
+  // the new window are dropped and the loaders start on index right away
+  void Seek(size_t index){
+    {
+      std::lock_guard<std::mutex> lg(mutex_);
+      if(active_ == false) return;
+      cursor_ = index;
+      Trim(index);
+    }
+    cv_.notify_all();
+  }
+
+  // recycled frame objects waiting for a loader, at most depth
+  size_t free_frames(){
+    std::lock_guard<std::mutex> lg(mutex_);
+    return free_frames_.size();
+  }
+
+  uint64_t hits() const { return hits_; }
+  uint64_t misses() const { return misses_; }
+
+private:
+  enum SlotState { LOADING, READY, FAILED };
+  struct Slot{
+    SlotState state;
+    size_t bytes;
+    int waiters;  // Get() calls waiting on it, the slot is not released while they do
+    T frame;
+  };
+
+  void LoaderThread(){
+    while(1){
+      std::unique_lock<std::mutex> ul(mutex_);
+      size_t index = 0;
+      cv_.wait(ul, [&]{ return active_ == false || NextToLoad(index); });
+      if(active_ == false) return;
+
+      Slot &slot = slots_[index];
+      slot.state = LOADING;
+      slot.waiters = 0;
+      slot.bytes = estimate_;  // reserved until the frame is loaded
+      bytes_ += slot.bytes;
+      T frame;
+      if(!free_frames_.empty()){
+        std::swap(frame, free_frames_.back());
+        free_frames_.pop_back();
+      }
+      ul.unlock();
+
+      bool ok = loader_(index, frame);
+      size_t bytes = ok ? size_of_(frame) : 0;
+
+      ul.lock();
+      auto iter = slots_.find(index);
+      std::swap(iter->second.frame, frame);
+      iter->second.state = ok ? READY : FAILED;
+      bytes_ = bytes_ - iter->second.bytes + bytes;
+      iter->second.bytes = bytes;
+      if(ok) estimate_ = bytes;
+      if(index + 1 < cursor_ && iter->second.waiters == 0) Release(iter); // playback already passed this frame
+      ul.unlock();
+      cv_.notify_all();
+    }
+  }
+
+  // First index of the window [cursor_, cursor_+depth_) that is neither loaded nor loading
+  bool NextToLoad(size_t &index){
+    if(bytes_ >= byte_budget_) return false;
+    for(size_t i = cursor_ ; i < cursor_ + depth_ && i < count_ ; i ++){
+      if(slots_.find(i) == slots_.end()){
+        index = i;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Release finished slots outside [index, index+depth_]
+  void Trim(size_t index){
+    for(auto iter = slots_.begin() ; iter != slots_.end() ; ){
+      auto cur = iter++;
+      if(cur->second.state == LOADING || cur->second.waiters > 0) continue;
+      if(cur->first < index || cur->first > index + depth_) Release(cur);
+    }
+  }
+
+  void Release(typename std::map<size_t, Slot>::iterator iter){
+    bytes_ -= iter->second.bytes;
+    if(free_frames_.size() < depth_) free_frames_.push_back(std::move(iter->second.frame));
+    slots_.erase(iter);
+  }
+
+  std::string name_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::thread> threads_;
+  std::map<size_t, Slot> slots_;
+  std::vector<T> free_frames_;
+  Loader loader_;
+  SizeOf size_of_;
+  size_t count_;
+  size_t depth_;
+  size_t byte_budget_;
+  size_t cursor_;
+  size_t bytes_;      // finished frames plus the reservations of the ones loading
+  size_t estimate_;   // size of the last loaded frame
+  size_t waiters_;    // Get() calls waiting on a slot
+  bool active_;
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+};
+
+#endif // FRAMEPREFETCHER_H
@@ -0,0 +1,88 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Summary of the samples of one interval. Percentiles are the upper bound of the log2
+// bucket the percentile falls in, so they are exact to within a factor of two.
+struct HistogramSummary{
+  uint64_t count;
+  double mean;
+  int64_t p50;
+  int64_t p99;
+  int64_t max;
+};
+
+// Lock-free log2 histogram of non-negative samples (ns, queue depths, ...).
+// Any thread may Record() concurrently; one reader periodically calls TakeInterval(),
+// which returns what was recorded since its previous call.
+class LatencyHistogram{
+
+public:
+  enum { NUM_BUCKETS = 64 };  // bucket 0 holds 0, bucket b holds [2^(b-1), 2^b)
+
+  LatencyHistogram() : count_(0), sum_(0), max_(0){
+    for(int b = 0 ; b < NUM_BUCKETS ; b ++) buckets_[b] = 0;
+  }
+
+  void Record(int64_t value){
+    if(value < 0) value = 0;
+    uint64_t v = static_cast<uint64_t>(value);
+    int bucket = (v == 0) ? 0 : 64 - __builtin_clzll(v);
+    if(bucket >= NUM_BUCKETS) bucket = NUM_BUCKETS - 1;
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(v, std::memory_order_relaxed);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while(v > max && !max_.compare_exchange_weak(max, v, std::memory_order_relaxed)){}
+  }
+
+  HistogramSummary TakeInterval(){
+    uint64_t buckets[NUM_BUCKETS];
+    HistogramSummary summary;
+    summary.count = 0;
+    for(int b = 0 ; b < NUM_BUCKETS ; b ++){
+      buckets[b] = buckets_[b].exchange(0, std::memory_order_relaxed);
+      summary.count += buckets[b];
+    }
+    count_.exchange(0, std::memory_order_relaxed);
+    uint64_t sum = sum_.exchange(0, std::memory_order_relaxed);
+    summary.max = static_cast<int64_t>(max_.exchange(0, std::memory_order_relaxed));
+    summary.mean = summary.count ? static_cast<double>(sum) / summary.count : 0.0;
+    summary.p50 = Percentile(buckets, summary.count, 0.50);
+    summary.p99 = Percentile(buckets, summary.count, 0.99);
+    if(summary.p50 > summary.max) summary.p50 = summary.max;
+    if(summary.p99 > summary.max) summary.p99 = summary.max;
+    return summary;
+  }
+
+  // samples recorded since the last TakeInterval()
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+
+private:
+  static int64_t Percentile(const uint64_t *buckets, uint64_t count, double q){
+    if(count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(q * (count - 1));
+    uint64_t seen = 0;
+    for(int b = 0 ; b < NUM_BUCKETS ; b ++){
+      seen += buckets[b];
+      if(seen > rank) return (b == 0) ? 0 : static_cast<int64_t>((b >= 63) ? INT64_MAX : (1LL << b) - 1);
+    }
+    return 0;
+  }
+
+  std::atomic<uint64_t> buckets_[NUM_BUCKETS];
+  std::atomic<uint64_t> count_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> max_;
+};
+
+// Publish timing of one sensor
+struct SensorStats{
+  LatencyHistogram lateness_;     // publish time - due time of the event (ns)
+  LatencyHistogram decode_;       // time to get the message ready (file read / decode / conversion, ns)
+  LatencyHistogram queue_depth_;  // events waiting in the sensor queue, sampled at each dispatch
+};
+
+#endif // LATENCYSTATS_H
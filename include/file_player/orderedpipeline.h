@@ -0,0 +1,121 @@
+#ifndef ORDEREDPIPELINE_H
+#define ORDEREDPIPELINE_H
+
+#include <map>
+#include <mutex>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+
+// Produce items 0..count-1 on a pool of worker threads and hand them to a single consumer
+// in index order. Items in production or waiting in the reorder buffer are at most max_items
+// and max_bytes bytes : an item being produced counts with the size of the last finished one
+// until its own size is known. The item the consumer needs next is always allowed to proceed,
+// so the caps never dead-lock the pipeline. Item objects are recycled between indices.
+template <typename T>
+class OrderedPipeline{
+
+public:
+  typedef std::function<bool(size_t index, T &item)> Producer;
+  typedef std::function<size_t(const T &item)> SizeOf;
+
+  OrderedPipeline(size_t count, Producer producer, SizeOf size_of, int num_workers, size_t max_bytes, size_t max_items)
+    : count_(count), producer_(producer), size_of_(size_of), max_bytes_(max_bytes), max_items_(std::max<size_t>(1, max_items)),
+      next_claim_(0), next_out_(0), bytes_(0), estimate_(0), active_(true)
+  {
+    for(int i = 0 ; i < std::max(1, num_workers) ; i ++)
+      workers_.push_back(std::thread(&OrderedPipeline::Worker, this));
+  }
+
+  ~OrderedPipeline(){
+    {
+      std::lock_guard<std::mutex> lg(mutex_);
+      active_ = false;
+    }
+    cv_.notify_all();
+    for(auto &th : workers_) if(th.joinable()) th.join();
+  }
+
+  // Swap the next item in order into item. ok is false when the producer failed for it.
+  // Returns false once every item has been handed out.
+  bool Next(size_t &index, T &item, bool &ok){
+    std::unique_lock<std::mutex> ul(mutex_);
+    if(next_out_ >= count_) return false;
+    cv_.wait(ul, [&]{ return done_.find(next_out_) != done_.end(); });
+    auto iter = done_.find(next_out_);
+    index = next_out_;
+    ok = iter->second.ok;
+    std::swap(item, iter->second.item);
+    bytes_ -= iter->second.bytes;
+    free_items_.push_back(std::move(iter->second.item));
+    done_.erase(iter);
+    next_out_++;
+    ul.unlock();
+    cv_.notify_all();
+    return true;
+  }
+
+private:
+  struct Done{
+    bool ok;
+    size_t bytes;
+    T item;
+  };
+
+  bool CanClaim() const {
+    if(next_claim_ >= count_) return false;
+    if(next_claim_ == next_out_) return true;
+    return next_claim_ < next_out_ + max_items_ && bytes_ < max_bytes_;
+  }
+
+  void Worker(){
+    while(1){
+      std::unique_lock<std::mutex> ul(mutex_);
+      cv_.wait(ul, [&]{ return active_ == false || next_claim_ >= count_ || CanClaim(); });
+      if(active_ == false || next_claim_ >= count_) return;
+      size_t index = next_claim_++;
+      const size_t reserved = estimate_;  // until the item is produced
+      bytes_ += reserved;
+      T item;
+      if(!free_items_.empty()){
+        std::swap(item, free_items_.back());
+        free_items_.pop_back();
+      }
+      ul.unlock();
+
+      bool ok = producer_(index, item);
+      size_t bytes = ok ? size_of_(item) : 0;
+
+      ul.lock();
+      Done &done = done_[index];
+      done.ok = ok;
+      done.bytes = bytes;
+      std::swap(done.item, item);
+      bytes_ = bytes_ - reserved + bytes;
+      if(ok) estimate_ = bytes;
+      ul.unlock();
+      cv_.notify_all();
+    }
+  }
+
+  size_t count_;
+  Producer producer_;
+  SizeOf size_of_;
+  size_t max_bytes_;
+  size_t max_items_;
+  size_t next_claim_;
+  size_t next_out_;
+  size_t bytes_;      // of the items in production (estimated) and in the reorder buffer
+  size_t estimate_;   // size of the last finished item
+  bool active_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::thread> workers_;
+  std::map<size_t, Done> done_;
+  std::vector<T> free_items_;
+};
+
+#endif // ORDEREDPIPELINE_H
@@ -0,0 +1,34 @@
+#ifndef OUSTERDECODER_H
+#define OUSTERDECODER_H
+
+#include <string>
+#include <stdint.h>
+#include <sensor_msgs/PointCloud2.h>
+
+// One MulRan Ouster .bin point is four little-endian float32 : x, y, z, intensity
+#define OUSTER_BIN_POINT_SIZE 16
+#define OUSTER_CHANNELS 64
+
+// Point layout written into sensor_msgs::PointCloud2::data.
+// Same fields as the former PCL PointXYZIRT, without the PCL_ADD_POINT4D / EIGEN_ALIGN16 padding.
+struct OusterPoint {
+  float x;
+  float y;
+  float z;
+  float intensity;
+  uint32_t t;
+  int32_t ring;
+};
+
+// Set fields, point_step and size of cloud for num_points points (data is resized, not cleared)
+void InitOusterCloud(sensor_msgs::PointCloud2 &cloud, size_t num_points);
+
+// OS1-64 rotation period at 10 Hz
+#define OUSTER_SCAN_PERIOD_NS 100000000u
+
+// Map the .bin file and decode it straight into cloud.data, no intermediate pcl::PointCloud.
+// A trailing partial point is ignored. ring and t are synthesized from the point index and
+// scan_period_ns (see pointfields.h).
+bool LoadOusterScan(const std::string &file_path, sensor_msgs::PointCloud2 &cloud, uint32_t scan_period_ns);
+
+#endif // OUSTERDECODER_H
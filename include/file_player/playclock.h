@@ -0,0 +1,119 @@
+#ifndef PLAYCLOCK_H
+#define PLAYCLOCK_H
+
+#include <cmath>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+
+// Dataset play position (ns since the start of the sequence) as a closed-form function of
+// the steady clock : position = anchor_position + (now - anchor_wall) * rate while running.
+// Seek, rate and run/pause changes re-anchor it at the current position, so nothing has to
+// integrate time. Readers never lock: the anchor is published seqlock style and a reader
+// that raced with a writer simply reads it again.
+class PlayClock{
+
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  PlayClock() : seq_(0), anchor_wall_(0), anchor_position_(0), rate_(1.0), running_(false){}
+
+  // position at the current wall time
+  int64_t Now() const {
+    return Snapshot().At(WallNs());
+  }
+
+  // wall time at which position is reached, time_point::max() while stopped
+  Clock::time_point WallTime(int64_t position) const {
+    Anchor anchor = Snapshot();
+    if(!anchor.running || anchor.rate <= 0.0) return Clock::time_point::max();
+    int64_t wall = anchor.wall + static_cast<int64_t>(std::ceil(static_cast<double>(position - anchor.position) / anchor.rate));
+    return Clock::time_point(std::chrono::nanoseconds(wall));
+  }
+
+  bool running() const { return Snapshot().running; }
+  double rate() const { return Snapshot().rate; }
+
+  void Seek(int64_t position){
+    std::lock_guard<std::mutex> lg(write_mutex_);
+    Anchor anchor = Snapshot();
+    anchor.wall = WallNs();
+    anchor.position = position;
+    Publish(anchor);
+  }
+
+  void SetRate(double rate){
+    std::lock_guard<std::mutex> lg(write_mutex_);
+    Anchor anchor = Snapshot();
+    Reanchor(anchor);
+    anchor.rate = rate;
+    Publish(anchor);
+  }
+
+  void SetRunning(bool running){
+    std::lock_guard<std::mutex> lg(write_mutex_);
+    Anchor anchor = Snapshot();
+    Reanchor(anchor);
+    anchor.running = running;
+    Publish(anchor);
+  }
+
+private:
+  struct Anchor{
+    int64_t wall;
+    int64_t position;
+    double rate;
+    bool running;
+
+    int64_t At(int64_t wall_ns) const {
+      if(!running) return position;
+      return position + static_cast<int64_t>(static_cast<double>(wall_ns - wall) * rate);
+    }
+  };
+
+  static int64_t WallNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+  }
+
+  static void Reanchor(Anchor &anchor){
+    int64_t now = WallNs();
+    anchor.position = anchor.At(now);
+    anchor.wall = now;
+  }
+
+  Anchor Snapshot() const {
+    Anchor anchor;
+    uint32_t seq;
+    do{
+      seq = seq_.load(std::memory_order_acquire);
+      anchor.wall = anchor_wall_.load(std::memory_order_relaxed);
+      anchor.position = anchor_position_.load(std::memory_order_relaxed);
+      anchor.rate = rate_.load(std::memory_order_relaxed);
+      anchor.running = running_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }while((seq & 1) || seq != seq_.load(std::memory_order_relaxed));
+    return anchor;
+  }
+
+  // writers hold write_mutex_
+  void Publish(const Anchor &anchor){
+    uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    anchor_wall_.store(anchor.wall, std::memory_order_relaxed);
+    anchor_position_.store(anchor.position, std::memory_order_relaxed);
+    rate_.store(anchor.rate, std::memory_order_relaxed);
+    running_.store(anchor.running, std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  std::mutex write_mutex_;
+  std::atomic<uint32_t> seq_;
+  std::atomic<int64_t> anchor_wall_;
+  std::atomic<int64_t> anchor_position_;
+  std::atomic<double> rate_;
+  std::atomic<bool> running_;
+};
+
+#endif // PLAYCLOCK_H
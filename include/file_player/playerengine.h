@@ -0,0 +1,246 @@
+#ifndef PLAYERENGINE_H
+#define PLAYERENGINE_H
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <ros/ros.h>
+#include <ros/time.h>
+#include <opencv/cv.h>
+#include <opencv/highgui.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <image_transport/image_transport.h>
+#include <image_transport/transport_hints.h>
+#include <cv_bridge/cv_bridge.h>
+
+#include <sensor_msgs/PointCloud2.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/CompressedImage.h>
+#include <sensor_msgs/LaserScan.h>
+
+#include <rosgraph_msgs/Clock.h>
+#include <topic_tools/shape_shifter.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+
+
+#include <camera_info_manager/camera_info_manager.h>
+#include <std_msgs/String.h>
+#include <std_msgs/Bool.h>
+#include <std_srvs/SetBool.h>
+#include <std_msgs/Int64MultiArray.h>
+#include <std_msgs/Float32.h>
+#include <std_msgs/Float64.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/CameraInfo.h>
+#include <sensor_msgs/SetCameraInfo.h>
+// #include <irp_sen_msgs/imu.h>
+
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/MagneticField.h>
+#include <nav_msgs/Odometry.h>
+#include <geometry_msgs/Quaternion.h>
+#include <tf/transform_datatypes.h>
+
+#include <dynamic_reconfigure/server.h>
+// #include <file_player/dynamic_file_playerConfig.h>
+#include <Eigen/Dense>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+//pcl
+#include <pcl_conversions/pcl_conversions.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "file_player/color.h"
+#include "rosbag/bag.h"
+#include <ros/transport_hints.h>
+#include "file_player/datathread.h"
+#include "file_player/ousterdecoder.h"
+#include "file_player/radardecoder.h"
+#include "file_player/radarray.h"
+#include "file_player/cloudreduction.h"
+#include "file_player/pointlayout.h"
+#include "file_player/frameprefetcher.h"
+#include "file_player/sequence.h"
+#include "file_player/bagexporter.h"
+#include "file_player/eventscheduler.h"
+#include "file_player/playclock.h"
+#include "file_player/latencystats.h"
+#include <sys/types.h>
+
+#include <algorithm>
+#include <iterator>
+#include <sys/types.h>
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <rosbag/bag.h>
+#include <sstream>
+#include "tf2/LinearMath/Matrix3x3.h"
+#include "tf2/LinearMath/Transform.h"
+#include "csetjmp"
+#include "eigen_conversions/eigen_msg.h"
+
+// Playback engine : loads a MulRan sequence and publishes it on its own threads.
+// Has no Qt in it, so the GUI (ROSThread) and the nodelet (PlayerNodelet) are thin
+// front-ends that only forward the hooks below.
+class PlayerEngine
+{
+
+public:
+    PlayerEngine();
+    virtual ~PlayerEngine();
+    // private_nh holds the ~ parameters, the node's ~ or a nodelet's private handle
+    void ros_initialize(ros::NodeHandle &n, const ros::NodeHandle &private_nh);
+    // stop and join every thread, safe to call more than once
+    void Shutdown();
+    ros::NodeHandle nh_;
+    ros::NodeHandle left_camera_nh_;
+    ros::NodeHandle right_camera_nh_;
+
+    int64_t initial_data_stamp_;
+    int64_t last_data_stamp_;
+
+    bool auto_start_flag_;
+    int stamp_show_count_;
+
+    bool play_flag_;
+    bool pause_flag_;
+    bool loop_flag_;
+    bool stop_skip_flag_;
+    bool lockstep_flag_;
+    double play_rate_;
+    std::string data_folder_path_;
+
+    int imu_data_version_;
+
+    void SaveRosbag();
+    void Ready();
+    void ResetProcessStamp(int position);
+    void SetPlayFlag(bool flag);
+    void SetPauseFlag(bool flag);
+    void SetPlayRate(double rate);
+    void SetLockstepFlag(bool flag);
+
+protected:
+    // called from the engine threads, overrides must not block
+    virtual void OnStamp(int64_t /*stamp*/) {}           // play position moved, every 100th data stamp
+    virtual void OnStart();                            // /file_player_start or the end of a stop period, toggles play
+    virtual void OnStats(const std::string &/*text*/) {} // stats summary of the last period
+
+private:
+
+    bool radarpolar_active_;
+    bool imu_active_;
+
+
+    ros::Subscriber start_sub_;
+    ros::Subscriber stop_sub_;
+    ros::Subscriber lockstep_ack_sub_;
+
+    // ros::Publisher imu_origin_pub_;
+    ros::Publisher gps_pub_;
+    ros::Publisher imu_pub_;
+    ros::Publisher magnet_pub_;
+    ros::Publisher ouster_pub_;
+    ros::Publisher ouster_reduced_pub_;
+    ros::Publisher radarpolar_pub_;
+    ros::Publisher radarpolar_compressed_pub_;
+    ros::Publisher radarray_pub_;
+    ros::Publisher clock_pub_;
+    ros::Publisher stats_pub_;
+
+    int64_t prev_clock_stamp_;
+
+    MulranSequence sequence_;
+    // map<int64_t, irp_sen_msgs::imu>         imu_data_origin_;
+
+    DataThread<int64_t> data_stamp_thread_;
+    // queue payload : the event with its table row and the seek generation it was dispatched in
+    struct SensorEvent{
+      int64_t stamp;
+      int32_t index;
+      uint32_t generation;
+    };
+    typedef DataThread<SensorEvent> SensorThread;
+    SensorThread gps_thread_;
+    SensorThread imu_thread_;
+    SensorThread radarpolar_thread_; 
+    SensorThread ouster_thread_;
+    SensorThread *sensor_threads_[NUM_SENSORS]; // dispatch table indexed by SensorId
+
+    std::map<int64_t, int64_t> stop_period_; //start and stop stamp
+
+    void DataStampThread();
+    void GpsThread();
+    void ImuThread();
+    void OusterThread(); // giseop
+    void RadarpolarThread(); 
+
+    void FilePlayerStart(const std_msgs::BoolConstPtr& msg);
+    void FilePlayerStop(const std_msgs::BoolConstPtr& msg);
+
+    PlayClock play_clock_;  // play position, ns after initial_data_stamp_
+
+    SensorStats sensor_stats_[NUM_SENSORS];
+    int64_t stats_late_warn_ns_;  // p99 lateness above this reports WARN
+    ros::Timer stats_timer_;
+    void RecordPublish(int sensor, int64_t stamp, PlayClock::Clock::time_point start, PlayClock::Clock::time_point ready);
+    void StatsCallback(const ros::TimerEvent& event);
+
+    // lockstep : events of lockstep_sensor_ wait until fewer than lockstep_window_ are unacked
+    int lockstep_sensor_;
+    uint64_t lockstep_window_;
+    double lockstep_timeout_;   // s, <= 0 waits forever
+    std::atomic<uint64_t> lockstep_sent_;
+    std::atomic<uint64_t> lockstep_acked_;
+    void LockstepAck(const topic_tools::ShapeShifter::ConstPtr& msg);
+    void UpdateClockRunning();
+
+    std::atomic<bool> reset_process_stamp_flag_;
+    std::atomic<uint32_t> seek_generation_;  // bumped by every seek, older queued events are dropped
+    std::atomic<int64_t> seek_start_ns_;     // steady time of the pending timed seek, 0 if none
+    LatencyHistogram seek_latency_;          // seek to first LiDAR publish (ns)
+    LatencyHistogram reduction_cost_;        // /os1_points_reduced reduction time per frame (ns)
+    LatencyHistogram reduction_points_;      // points kept per frame
+    void SeekTo(int64_t position);
+    EventScheduler scheduler_;
+
+    FramePrefetcher<sensor_msgs::PointCloud2> ouster_prefetcher_;
+    size_t ouster_prefetch_depth_;
+    size_t ouster_prefetch_bytes_;
+    int ouster_prefetch_threads_;
+
+    int export_threads_;
+    size_t export_memory_bytes_;
+    int64_t export_split_duration_;   // "Save bag" splits, see ExportOptions
+    uint64_t export_split_bytes_;
+    int64_t export_split_overlap_;
+    int export_split_writers_;
+    double export_checkpoint_period_;  // "Save bag" closes a segment every period [s], see ExportOptions
+    bool export_resume_;  // "Save bag" goes on after the segments it closed, see ExportOptions
+    FramePrefetcher<RadarPolarFrame> radarpolar_prefetcher_;
+    size_t radarpolar_prefetch_depth_;
+    size_t radarpolar_prefetch_bytes_;
+    int radarpolar_prefetch_threads_;
+    uint32_t ouster_scan_period_ns_;  // per-point t of the LiDAR clouds spans one rotation
+    bool reduction_active_;           // ~reduce : publish /os1_points_reduced as well
+    ReductionOptions reduction_;
+    PointLayout point_layout_;        // ~point_layout of both LiDAR topics
+    float point_scale_;               // xyz16 step [m]
+    bool radarpolar_raw_;         // /radar/polar (decoded)
+    bool radarpolar_compressed_;  // /radar/polar/compressed (PNG passthrough)
+    bool radarray_source_;        // ~radar_source ray : /radar/oxford from radar/ray/*.csv
+    bool radarray_active_;        // ray files found for the loaded sequence
+
+};
+
+#endif // PLAYERENGINE_H
\ No newline at end of file
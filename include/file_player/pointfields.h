@@ -0,0 +1,41 @@
+#ifndef POINTFIELDS_H
+#define POINTFIELDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "file_player/ousterdecoder.h"
+
+// Synthesis of the per-point fields a MulRan .bin scan does not store.
+// The scan is column-major : point k belongs to beam (k % 64) of firing column k / 64, so
+//   ring = (k % 64) + 1
+//   t    = column * scan_period_ns / columns   (ns since the first column, columns = n / 64)
+// which is what deskewing LIO front ends (LIO-SAM, FAST-LIO) read from an OS1-64 cloud.
+// Points of a trailing partial column get the time of the column after the last full one.
+
+// Copy num_points x, y, z, intensity from bin (16 bytes per point) into points and fill
+// ring and t. Uses AVX2 when the CPU has it, SSE2 otherwise.
+void WriteOusterPoints(const uint8_t *bin, OusterPoint *points, size_t num_points, uint32_t scan_period_ns);
+
+// Plain C++ reference of WriteOusterPoints, same output bit for bit
+void WriteOusterPointsScalar(const uint8_t *bin, OusterPoint *points, size_t num_points, uint32_t scan_period_ns);
+
+// The kernels behind WriteOusterPoints, for tests and benchmarks
+enum PointFieldsKernel{
+  POINT_FIELDS_SCALAR,
+  POINT_FIELDS_SSE2,
+  POINT_FIELDS_AVX2,
+  NUM_POINT_FIELDS_KERNELS
+};
+
+// false when the build or the CPU does not have kernel
+bool PointFieldsKernelSupported(PointFieldsKernel kernel);
+
+// the kernel WriteOusterPoints runs on this CPU
+PointFieldsKernel BestPointFieldsKernel();
+
+// WriteOusterPoints with the given kernel, which must be supported
+void WriteOusterPointsWith(PointFieldsKernel kernel, const uint8_t *bin, OusterPoint *points, size_t num_points,
+                           uint32_t scan_period_ns);
+
+#endif // POINTFIELDS_H
@@ -0,0 +1,202 @@
+#ifndef POINTLAYOUT_H
+#define POINTLAYOUT_H
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "file_player/ousterdecoder.h"
+
+// Wire layouts a decoded Ouster cloud (OusterPoint, 24 bytes) can be published / exported in.
+//   full   : x y z intensity (float32), t (uint32, ns), ring (int32)          24 bytes
+//   xyzi   : x y z intensity (float32)                                        16 bytes
+//   xyzirt : x y z intensity (float32), ring (uint16), time (float32, s)      22 bytes, packed
+//            the Velodyne-style layout LIO front ends read
+//   xyz16  : x y z (int16, value / scale), intensity (uint16, clamped)         8 bytes
+//
+// The xyz16 scale convention : the step (m) of the int16 coordinates travels in the cloud
+// itself, as one extra PointField named "xyz_scale=<scale>" (printf %g), datatype FLOAT32,
+// offset 0, count 0. A count 0 field describes no bytes of the point, so generic readers
+// (pcl::fromROSMsg, rviz) skip it, and the scale stays with every message : in exported bags
+// and across nodelets, where a parameter would not follow it. PointLayoutOf() reads it back.
+enum PointLayout{
+  POINT_LAYOUT_FULL = 0,
+  POINT_LAYOUT_XYZI,
+  POINT_LAYOUT_XYZIRT,
+  POINT_LAYOUT_XYZ16,
+};
+
+#define POINT_LAYOUT_SCALE_FIELD "xyz_scale="
+
+// "full", "xyzi", "xyzirt", "xyz16"; false for an unknown name
+bool ParsePointLayout(const std::string &name, PointLayout &layout);
+
+// point_step of layout in bytes
+uint32_t PointLayoutStep(PointLayout layout);
+
+// Re-encode an OusterPoint cloud (InitOusterCloud layout) into layout. scale is the int16
+// step of xyz16 in meters. header is copied; out must not be in.
+void EncodeOusterCloud(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out, PointLayout layout, float scale);
+
+// Layout (and xyz16 scale, 0 for the other layouts) of a cloud written by EncodeOusterCloud,
+// false when its fields match none of them
+bool PointLayoutOf(const sensor_msgs::PointCloud2 &cloud, PointLayout &layout, float &scale);
+
+// Back to the OusterPoint layout, fields the layout drops (t, ring) are 0. false when the
+// layout of in is unknown. header is copied; out must not be in.
+bool DecodeOusterCloud(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out);
+
+
+// Per-layout encoders, specialized at compile time so the point loop is a straight copy.
+// Each has STEP (point_step), AddFields(cloud, scale), Encode(point, dst, inv_scale) and
+// Decode(src, point, scale).
+namespace point_layout {
+
+inline void
+AddField(sensor_msgs::PointCloud2 &cloud, const std::string &name, uint32_t offset, uint8_t datatype, uint32_t count = 1)
+{
+  sensor_msgs::PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = count;
+  cloud.fields.push_back(field);
+}
+
+struct Xyzi{
+  enum { STEP = 16 };
+  static void AddFields(sensor_msgs::PointCloud2 &cloud, float){
+    AddField(cloud, "x", 0, sensor_msgs::PointField::FLOAT32);
+    AddField(cloud, "y", 4, sensor_msgs::PointField::FLOAT32);
+    AddField(cloud, "z", 8, sensor_msgs::PointField::FLOAT32);
+    AddField(cloud, "intensity", 12, sensor_msgs::PointField::FLOAT32);
+  }
+  static void Encode(const OusterPoint &p, uint8_t *dst, float){
+    memcpy(dst, &p.x, 16);
+  }
+  static void Decode(const uint8_t *src, OusterPoint &p, float){
+    memcpy(&p.x, src, 16);
+    p.t = 0;
+    p.ring = 0;
+  }
+};
+
+struct Xyzirt{
+  enum { STEP = 22 };
+  static void AddFields(sensor_msgs::PointCloud2 &cloud, float scale){
+    Xyzi::AddFields(cloud, scale);
+    AddField(cloud, "ring", 16, sensor_msgs::PointField::UINT16);
+    AddField(cloud, "time", 18, sensor_msgs::PointField::FLOAT32);
+  }
+  static void Encode(const OusterPoint &p, uint8_t *dst, float){
+    uint16_t ring = static_cast<uint16_t>(p.ring);
+    float time = static_cast<float>(p.t) * 1e-9f;
+    memcpy(dst, &p.x, 16);
+    memcpy(dst + 16, &ring, 2);
+    memcpy(dst + 18, &time, 4);
+  }
+  static void Decode(const uint8_t *src, OusterPoint &p, float){
+    uint16_t ring;
+    float time;
+    memcpy(&p.x, src, 16);
+    memcpy(&ring, src + 16, 2);
+    memcpy(&time, src + 18, 4);
+    p.ring = ring;
+    p.t = static_cast<uint32_t>(time * 1e9 + 0.5);
+  }
+};
+
+struct Xyz16{
+  enum { STEP = 8 };
+  static void AddFields(sensor_msgs::PointCloud2 &cloud, float scale){
+    AddField(cloud, "x", 0, sensor_msgs::PointField::INT16);
+    AddField(cloud, "y", 2, sensor_msgs::PointField::INT16);
+    AddField(cloud, "z", 4, sensor_msgs::PointField::INT16);
+    AddField(cloud, "intensity", 6, sensor_msgs::PointField::UINT16);
+    char name[64];
+    snprintf(name, sizeof(name), POINT_LAYOUT_SCALE_FIELD "%g", scale);
+    AddField(cloud, name, 0, sensor_msgs::PointField::FLOAT32, 0);
+  }
+  // the scale as a reader parses it back from the field name, the one to quantize with
+  // (1 m when scale is not positive)
+  static float PrintedScale(float scale){
+    if(!(scale > 0.0f)) scale = 1.0f;
+    char text[32];
+    snprintf(text, sizeof(text), "%g", scale);
+    return strtof(text, NULL);
+  }
+  // clamped to +-32767, NaN ends up at the low bound
+  static int16_t Quantize(float v, float inv_scale){
+    float q = v * inv_scale;
+    q = (q > -32767.0f) ? q : -32767.0f;
+    q = (q < 32767.0f) ? q : 32767.0f;
+    return static_cast<int16_t>(static_cast<int32_t>((q + 12582912.0f) - 12582912.0f));  // 1.5 * 2^23 : round to nearest
+  }
+  struct Point{
+    int16_t x, y, z;
+    uint16_t intensity;
+  };
+  static void Encode(const OusterPoint &p, uint8_t *dst, float inv_scale){
+    float i = (p.intensity > 0.0f) ? p.intensity : 0.0f;
+    i = (i < 65535.0f) ? i : 65535.0f;
+    Point q;
+    q.x = Quantize(p.x, inv_scale);
+    q.y = Quantize(p.y, inv_scale);
+    q.z = Quantize(p.z, inv_scale);
+    q.intensity = static_cast<uint16_t>(static_cast<int32_t>(i + 0.5f));
+    memcpy(dst, &q, sizeof(q));
+  }
+  static void Decode(const uint8_t *src, OusterPoint &p, float scale){
+    Point q;
+    memcpy(&q, src, sizeof(q));
+    p.x = q.x * scale;
+    p.y = q.y * scale;
+    p.z = q.z * scale;
+    p.intensity = q.intensity;
+    p.t = 0;
+    p.ring = 0;
+  }
+};
+
+template <typename Layout>
+void
+Encode(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out, float scale)
+{
+  const size_t num_points = in.data.size() / sizeof(OusterPoint);
+  out.header = in.header;
+  out.fields.clear();
+  Layout::AddFields(out, scale);
+  out.height = 1;
+  out.width = num_points;
+  out.is_bigendian = false;
+  out.is_dense = in.is_dense;
+  out.point_step = Layout::STEP;
+  out.row_step = out.point_step * out.width;
+  out.data.resize(static_cast<size_t>(out.row_step));
+
+  const OusterPoint *src = reinterpret_cast<const OusterPoint *>(in.data.data());
+  uint8_t *dst = out.data.data();
+  const float inv_scale = scale > 0.0f ? 1.0f / scale : 1.0f;
+  for(size_t k = 0 ; k < num_points ; k++, dst += Layout::STEP) Layout::Encode(src[k], dst, inv_scale);
+}
+
+template <typename Layout>
+void
+Decode(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out, float scale)
+{
+  const size_t num_points = in.data.size() / Layout::STEP;
+  out.fields.clear();
+  InitOusterCloud(out, num_points);
+  out.header = in.header;
+  out.is_dense = in.is_dense;
+  const uint8_t *src = in.data.data();
+  OusterPoint *dst = reinterpret_cast<OusterPoint *>(out.data.data());
+  for(size_t k = 0 ; k < num_points ; k++, src += Layout::STEP) Layout::Decode(src, dst[k], scale);
+}
+
+} // namespace point_layout
+
+#endif // POINTLAYOUT_H
@@ -0,0 +1,26 @@
+#ifndef RADARDECODER_H
+#define RADARDECODER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <opencv2/core/core.hpp>
+
+// CompressedImage format of the MulRan radar/polar/<stamp>.png files (8 bit single channel)
+#define RADAR_POLAR_FORMAT "mono8; png"
+
+// One radar polar scan as read from disk : the PNG file bytes and, when asked for, the
+// decoded image. Both buffers are reused when a frame is loaded again.
+struct RadarPolarFrame{
+  std::vector<uint8_t> png;
+  cv::Mat image;
+};
+
+// Read a whole file into bytes (resized, capacity is kept between calls)
+bool ReadFileBytes(const std::string &file_path, std::vector<uint8_t> &bytes);
+
+// Read radar/polar/<stamp>.png into frame.png and, if decode, decode it as grayscale into
+// frame.image (in place when it already has the right size and type).
+bool LoadRadarPolar(const std::string &file_path, RadarPolarFrame &frame, bool decode);
+
+#endif // RADARDECODER_H
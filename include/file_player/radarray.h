@@ -0,0 +1,21 @@
+#ifndef RADARRAY_H
+#define RADARRAY_H
+
+#include <string>
+#include <stdint.h>
+#include <opencv2/core/core.hpp>
+
+// MulRan radar/ray/<stamp>.csv : one line per azimuth,
+//   <stamp ns>,<angle deg>,<azimuth encoder count>,<counter>,<intensity bin 0>,<bin 1>,...
+// converted to the Oxford Radar RobotCar polar layout (utils/mulran2oxfordFormat.m) :
+// one 8 bit row per azimuth, columns 0-7 the stamp (int64 little-endian), 8-9 the encoder
+// count (uint16 little-endian), 10 a valid flag (255), then the intensity bins.
+#define RADAR_OXFORD_META_COLUMNS 11
+
+// Parse a ray CSV into an Oxford-format image (CV_8UC1, one row per azimuth line). The
+// stamps are kept exact, intensities are rounded and clamped to 0..255 and bins missing
+// from short lines are 0. Like the other CSV parsers, parsing stops at the first malformed
+// line. image is reused when it already has the right size.
+bool LoadRadarRayCsv(const std::string &file_path, cv::Mat &image);
+
+#endif // RADARRAY_H
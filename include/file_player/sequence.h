@@ -0,0 +1,111 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/NavSatFix.h>
+#include <sensor_msgs/MagneticField.h>
+
+#include "file_player/stampindex.h"
+#include "file_player/timeline.h"
+
+struct ImuRow;
+struct GpsRow;
+
+struct Vec3{
+  double x, y, z;
+};
+
+struct Quat{
+  double x, y, z, w;
+};
+
+// IMU samples as sorted columns; messages are only built when published or exported
+struct ImuTable{
+
+  std::vector<int64_t> stamps_;
+  std::vector<Quat> orientation_;
+  std::vector<Vec3> gyro_;
+  std::vector<Vec3> accel_;
+  std::vector<Vec3> mag_;
+  bool has_motion_;   // gyro, accel and mag columns are filled (17 field xsens_imu.csv)
+
+  ImuTable() : has_motion_(false){}
+  void clear();
+  void Build(const std::vector<ImuRow> &rows);
+  size_t size() const { return stamps_.size(); }
+  int64_t Find(int64_t stamp) const;         // index of stamp, -1 if absent
+  size_t LowerBound(int64_t stamp) const;
+  void ToMsg(size_t i, sensor_msgs::Imu &msg) const;
+  void ToMsg(size_t i, sensor_msgs::MagneticField &msg) const;
+  size_t MemoryBytes() const;
+
+};
+
+// GPS fixes as sorted columns
+struct GpsTable{
+
+  std::vector<int64_t> stamps_;
+  std::vector<double> latitude_;
+  std::vector<double> longitude_;
+  std::vector<double> altitude_;
+  std::vector<double> covariance_;    // 9 per fix
+
+  void clear();
+  void Build(const std::vector<GpsRow> &rows);
+  size_t size() const { return stamps_.size(); }
+  int64_t Find(int64_t stamp) const;
+  size_t LowerBound(int64_t stamp) const;
+  void ToMsg(size_t i, sensor_msgs::NavSatFix &msg) const;
+  size_t MemoryBytes() const;
+
+};
+
+// Sensor tables of one MulRan sequence (<data_folder>/sensor_data/...), without any Qt or
+// publishing code, so both the player and the headless exporter load sequences the same way.
+struct MulranSequence{
+
+  MulranSequence();
+
+  std::string data_folder_path_;
+
+  int64_t initial_data_stamp_;
+  int64_t last_data_stamp_;
+  int imu_data_version_;
+
+  // read / write sensor_data/.file_player_cache (see sequencecache.h)
+  bool use_cache_;
+
+  Timeline                                           data_stamp_;
+  GpsTable                                           gps_data_;
+  ImuTable                                           imu_data_;  // magnetometer included
+
+  StampIndex ouster_file_stamps_;
+  StampIndex radarpolar_file_stamps_;
+  StampIndex radarray_file_stamps_;  // only listed by UseRadarRay()
+
+  // Read data_stamp.csv, gps.csv, xsens_imu.csv (if load_imu) and list the Ouster / radar files.
+  // The CSV files share num_threads parse threads (0 : one per core).
+  // Returns false when data_stamp.csv does not exist.
+  bool Load(const std::string &data_folder_path, bool load_imu, int num_threads = 0);
+
+  std::string OusterPath(int64_t stamp) const;
+  std::string RadarpolarPath(int64_t stamp) const;
+  std::string RadarrayPath(int64_t stamp) const;
+
+  // List radar/ray/<stamp>.csv and resolve the radar events against those files instead of
+  // radar/polar (call after Load). Returns false when there are no ray files, the events then
+  // still point at radar/polar.
+  bool UseRadarRay();
+
+  // print the size of the tables next to what per-sample message maps would take
+  void PrintMemoryReport() const;
+
+};
+
+// List <stamp>.<ext> files of dir into files (sorted and indexed)
+int GetDirList(std::string dir, StampIndex &files);
+
+#endif // SEQUENCE_H
@@ -0,0 +1,50 @@
+#ifndef SEQUENCECACHE_H
+#define SEQUENCECACHE_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "file_player/csvparser.h"
+
+// Versioned binary sidecar of the parsed sensor tables of one sequence
+// (<data_folder>/sensor_data/.file_player_cache).
+// It is only used while the size and mtime of every CSV file and the mtime of the Ouster and
+// radar directories match the ones recorded when it was written; it is read with a single mmap.
+#define SEQUENCE_CACHE_NAME ".file_player_cache"
+#define SEQUENCE_CACHE_VERSION 1
+#define SEQUENCE_CACHE_SOURCES 5  // data_stamp.csv, gps.csv, xsens_imu.csv, Ouster, radar/polar
+
+// size and mtime of every source, -1 when it is missing
+struct SequenceSources{
+  struct{
+    int64_t size;
+    int64_t mtime_ns;
+  } files[SEQUENCE_CACHE_SOURCES];
+};
+
+struct SequenceTables{
+  std::vector<StampRow> stamps;
+  std::vector<GpsRow> gps;
+  std::vector<ImuRow> imu;
+  bool has_imu;
+  std::vector<int64_t> ouster_stamps;
+  std::vector<int64_t> radarpolar_stamps;
+};
+
+// Fill tables from the cache of data_folder when it is valid (and holds IMU rows if need_imu)
+bool LoadSequenceCache(const std::string &data_folder, bool need_imu, SequenceTables &tables);
+
+// Take the sources of data_folder. They must be taken before the tables are parsed, so a
+// file changed while parsing invalidates the cache instead of being hidden by it.
+void GetSequenceSources(const std::string &data_folder, SequenceSources &sources);
+
+// (Re)write the cache of data_folder for tables parsed from sources, false when it can not
+// be written (e.g. sensor_data is read-only)
+bool SaveSequenceCache(const std::string &data_folder, const SequenceSources &sources, const SequenceTables &tables);
+
+// Hex digest of the sizes and mtimes the cache is validated with : it changes whenever the
+// data of the sequence does (the bag exporter keys its checkpoints and manifests on it)
+std::string SequenceSourceDigest(const std::string &data_folder);
+
+#endif // SEQUENCECACHE_H
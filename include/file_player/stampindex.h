@@ -0,0 +1,47 @@
+#ifndef STAMPINDEX_H
+#define STAMPINDEX_H
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <unordered_map>
+
+// Sorted stamps of the files of one sensor directory (<stamp>.bin, <stamp>.png ...),
+// with an O(1) stamp -> index table built once when the sequence is loaded.
+struct StampIndex{
+
+  std::vector<int64_t> stamps_;
+  std::unordered_map<int64_t, size_t> index_;
+
+  void clear(){
+    stamps_.clear();
+    index_.clear();
+  }
+
+  void Build(){
+    std::sort(stamps_.begin(), stamps_.end());
+    stamps_.erase(std::unique(stamps_.begin(), stamps_.end()), stamps_.end());
+    index_.clear();
+    index_.reserve(stamps_.size());
+    for(size_t i = 0 ; i < stamps_.size() ; i ++) index_[stamps_[i]] = i;
+  }
+
+  // index of the file with exactly this stamp, -1 if there is none
+  int64_t Find(int64_t stamp) const {
+    auto iter = index_.find(stamp);
+    if(iter == index_.end()) return -1;
+    return static_cast<int64_t>(iter->second);
+  }
+
+  // index of the first file at or after stamp, size() if there is none
+  size_t LowerBound(int64_t stamp) const {
+    return std::lower_bound(stamps_.begin(), stamps_.end(), stamp) - stamps_.begin();
+  }
+
+  size_t size() const { return stamps_.size(); }
+  bool empty() const { return stamps_.empty(); }
+  int64_t operator[](size_t i) const { return stamps_[i]; }
+
+};
+
+#endif // STAMPINDEX_H
@@ -0,0 +1,77 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+// Sensor registry of the data_stamp.csv event timeline
+enum SensorId{
+  SENSOR_IMU = 0,
+  SENSOR_GPS,
+  SENSOR_OUSTER,
+  SENSOR_RADAR,
+  SENSOR_UNKNOWN,
+  NUM_SENSORS
+};
+
+// names used in data_stamp.csv, indexed by SensorId
+static const char *const kSensorNames[NUM_SENSORS] = {"imu", "gps", "ouster", "radar", "unknown"};
+
+inline SensorId
+SensorIdFromName(const std::string &name)
+{
+  for(int i = 0 ; i < SENSOR_UNKNOWN ; i ++)
+    if(name == kSensorNames[i]) return static_cast<SensorId>(i);
+  return SENSOR_UNKNOWN;
+}
+
+struct TimelineEvent{
+  int64_t stamp;
+  int32_t index;    // row of the sensor table / file list holding this event, -1 if it has none
+  uint8_t sensor;   // SensorId
+};
+
+// All sensor events of a sequence as one flat array sorted by stamp
+// (events with equal stamps keep their data_stamp.csv order)
+struct Timeline{
+
+  std::vector<TimelineEvent> events_;
+
+  void clear(){ events_.clear(); }
+
+  void Add(int64_t stamp, SensorId sensor){
+    TimelineEvent event;
+    event.stamp = stamp;
+    event.index = -1;
+    event.sensor = static_cast<uint8_t>(sensor);
+    events_.push_back(event);
+  }
+
+  void Sort(){
+    std::stable_sort(events_.begin(), events_.end(),
+                     [](const TimelineEvent &a, const TimelineEvent &b){ return a.stamp < b.stamp; });
+  }
+
+  // index of the first event at or after stamp, size() if there is none
+  size_t LowerBound(int64_t stamp) const {
+    return std::lower_bound(events_.begin(), events_.end(), stamp,
+                            [](const TimelineEvent &e, int64_t s){ return e.stamp < s; }) - events_.begin();
+  }
+
+  // index of the first event with exactly this stamp, size() if there is none
+  size_t Find(int64_t stamp) const {
+    size_t i = LowerBound(stamp);
+    return (i < events_.size() && events_[i].stamp == stamp) ? i : events_.size();
+  }
+
+  size_t size() const { return events_.size(); }
+  bool empty() const { return events_.empty(); }
+  const TimelineEvent &operator[](size_t i) const { return events_[i]; }
+  const TimelineEvent &front() const { return events_.front(); }
+  const TimelineEvent &back() const { return events_.back(); }
+
+};
+
+#endif // TIMELINE_H
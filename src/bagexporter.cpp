@@ -0,0 +1,606 @@
+#include "file_player/bagexporter.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <ros/serialization.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#include "file_player/ousterdecoder.h"
+#include "file_player/cloudreduction.h"
+#include "file_player/radardecoder.h"
+#include "file_player/exportstream.h"
+#include "file_player/exportcheckpoint.h"
+#include "file_player/sequencecache.h"
+#include "file_player/orderedpipeline.h"
+
+using namespace std;
+
+namespace {
+
+// Rows [begin, end) of a columnar sensor table, materialized into messages one at a time
+template <typename Table, typename M>
+class TableExportStream : public ExportStream{
+public:
+  TableExportStream(const string &topic, const Table &table, size_t begin, size_t end, int64_t last_stamp)
+    : topic_(topic), table_(table), index_(begin), end_(end), count_(0), last_stamp_(last_stamp){}
+
+  bool Peek(int64_t &stamp) override {
+    if(index_ >= end_) return false;
+    stamp = table_.stamps_[index_];
+    return true;
+  }
+
+  void Write(rosbag::Bag &bag) override {
+    table_.ToMsg(index_, msg_);
+    bag.write(topic_, msg_.header.stamp, msg_);
+    last_stamp_ = table_.stamps_[index_];
+    index_++;
+    count_++;
+  }
+
+  size_t count() const { return count_; }
+  int64_t last_stamp() const { return last_stamp_; }
+
+private:
+  string topic_;
+  const Table &table_;
+  size_t index_;
+  size_t end_;
+  M msg_;
+  size_t count_;
+  int64_t last_stamp_;  // of the last row written
+};
+
+// One decoded scan and, when asked for, its reduced copy
+struct OusterExportFrame{
+  OusterExportFrame() : reduce_ns(0){}
+
+  sensor_msgs::PointCloud2 cloud;
+  sensor_msgs::PointCloud2 reduced;
+  int64_t reduce_ns;
+};
+
+// Ouster scans coming out of the decode pipeline, in stamp order
+class OusterExportStream : public ExportStream{
+public:
+  OusterExportStream(OrderedPipeline<OusterExportFrame> &pipeline, const MulranSequence &sequence, size_t first_index,
+                     bool write_full, bool write_reduced, int64_t last_stamp)
+    : pipeline_(pipeline), sequence_(sequence), first_index_(first_index), write_full_(write_full), write_reduced_(write_reduced),
+      last_stamp_(last_stamp), loaded_(false), frame_count_(0), byte_count_(0), reduced_points_(0), reduce_ns_(0), reduce_max_ns_(0){}
+
+  bool Peek(int64_t &stamp) override {
+    size_t index;
+    bool ok;
+    while(!loaded_ && pipeline_.Next(index, frame_, ok)){
+      stamp_ = sequence_.ouster_file_stamps_[first_index_ + index];
+      if(!ok){
+        std::cerr << "Failed to open LiDAR file: " << sequence_.OusterPath(stamp_) << std::endl;
+        last_stamp_ = stamp_;
+        continue;
+      }
+      loaded_ = true;
+    }
+    stamp = stamp_;
+    return loaded_;
+  }
+
+  void Write(rosbag::Bag &bag) override {
+    ros::Time stamp = ros::Time().fromNSec(stamp_);
+    if(write_full_){
+      frame_.cloud.header.stamp = stamp;
+      frame_.cloud.header.frame_id = "ouster";
+      bag.write("/os1_points", stamp, frame_.cloud);
+      byte_count_ += frame_.cloud.data.size();
+    }
+    if(write_reduced_){
+      frame_.reduced.header.stamp = stamp;
+      frame_.reduced.header.frame_id = "ouster";
+      bag.write("/os1_points_reduced", stamp, frame_.reduced);
+      reduced_points_ += frame_.reduced.width;
+      reduce_ns_ += frame_.reduce_ns;
+      reduce_max_ns_ = std::max(reduce_max_ns_, frame_.reduce_ns);
+    }
+    last_stamp_ = stamp_;
+    loaded_ = false;
+    frame_count_++;
+  }
+
+  size_t frame_count() const { return frame_count_; }
+  size_t byte_count() const { return byte_count_; }
+  size_t reduced_points() const { return reduced_points_; }
+  int64_t reduce_ns() const { return reduce_ns_; }
+  int64_t reduce_max_ns() const { return reduce_max_ns_; }
+  int64_t last_stamp() const { return last_stamp_; }
+
+private:
+  OrderedPipeline<OusterExportFrame> &pipeline_;
+  const MulranSequence &sequence_;
+  size_t first_index_;
+  bool write_full_;
+  bool write_reduced_;
+  OusterExportFrame frame_;
+  int64_t stamp_;
+  int64_t last_stamp_;  // of the last scan written or skipped
+  bool loaded_;
+  size_t frame_count_;
+  size_t byte_count_;
+  size_t reduced_points_;
+  int64_t reduce_ns_;
+  int64_t reduce_max_ns_;
+};
+
+// Radar polar images, the PNG file bytes go into the bag without being decoded
+class RadarExportStream : public ExportStream{
+public:
+  RadarExportStream(const MulranSequence &sequence, size_t begin, size_t end, int64_t last_stamp)
+    : sequence_(sequence), index_(begin), end_(end), frame_count_(0), byte_count_(0), last_stamp_(last_stamp){
+    msg_.header.frame_id = "radar_polar";
+    msg_.format = RADAR_POLAR_FORMAT;
+  }
+
+  bool Peek(int64_t &stamp) override {
+    if(index_ >= end_) return false;
+    stamp = sequence_.radarpolar_file_stamps_[index_];
+    return true;
+  }
+
+  void Write(rosbag::Bag &bag) override {
+    int64_t stamp = sequence_.radarpolar_file_stamps_[index_++];
+    last_stamp_ = stamp;
+    if(!ReadFileBytes(sequence_.RadarpolarPath(stamp), msg_.data)){
+      std::cerr << "Failed to open radar file: " << sequence_.RadarpolarPath(stamp) << std::endl;
+      return;
+    }
+    msg_.header.stamp.fromNSec(stamp);
+    bag.write("/radar/polar/compressed", msg_.header.stamp, msg_);
+    frame_count_++;
+    byte_count_ += msg_.data.size();
+  }
+
+  size_t frame_count() const { return frame_count_; }
+  size_t byte_count() const { return byte_count_; }
+  int64_t last_stamp() const { return last_stamp_; }
+
+private:
+  const MulranSequence &sequence_;
+  size_t index_;
+  size_t end_;
+  sensor_msgs::CompressedImage msg_;
+  size_t frame_count_;
+  size_t byte_count_;
+  int64_t last_stamp_;  // of the last image written or skipped
+};
+
+// What went into one bag
+struct ExportCounts{
+  ExportCounts() : imu(0), gps(0), ouster_frames(0), ouster_bytes(0), reduced_points(0), reduce_ns(0), reduce_max_ns(0),
+                   radar_frames(0), radar_bytes(0){}
+
+  void Add(const ExportCounts &other){
+    imu += other.imu;
+    gps += other.gps;
+    ouster_frames += other.ouster_frames;
+    ouster_bytes += other.ouster_bytes;
+    reduced_points += other.reduced_points;
+    reduce_ns += other.reduce_ns;
+    reduce_max_ns = std::max(reduce_max_ns, other.reduce_max_ns);
+    radar_frames += other.radar_frames;
+    radar_bytes += other.radar_bytes;
+  }
+
+  size_t imu;
+  size_t gps;
+  size_t ouster_frames;
+  size_t ouster_bytes;
+  size_t reduced_points;
+  int64_t reduce_ns;
+  int64_t reduce_max_ns;
+  size_t radar_frames;
+  size_t radar_bytes;
+};
+
+int64_t
+FileBytes(const std::string &path)
+{
+  struct stat st;
+  return (stat(path.c_str(), &st) == 0) ? static_cast<int64_t>(st.st_size) : 0;
+}
+
+// Rows [begin, end) of a stamp-sorted table holding the stamps [first, last]
+template <typename Table>
+void
+StampRows(const Table &table, int64_t first, int64_t last, size_t &begin, size_t &end)
+{
+  begin = table.LowerBound(first);
+  end = (last == std::numeric_limits<int64_t>::max()) ? table.size() : table.LowerBound(last + 1);
+  if(end < begin) end = begin;
+}
+
+// First of the rows [begin, end) after last_stamp, the last one a resumed export wrote (-1 : none)
+template <typename Table>
+size_t
+ResumeRow(const Table &table, size_t begin, size_t end, int64_t last_stamp)
+{
+  if(last_stamp < 0) return begin;
+  return std::min(end, std::max(begin, table.LowerBound(last_stamp + 1)));
+}
+
+// Everything that decides the content of the bags, checkpoints and manifests are only
+// reused when it is unchanged
+std::string
+OptionsKey(const ExportOptions &options)
+{
+  const ReductionOptions &r = options.reduction;
+  std::ostringstream key;
+  key << std::setprecision(9)
+      << "topics " << options.imu << options.gps << options.ouster << options.ouster_reduced << options.radar
+      << " range " << options.start_stamp << " " << options.end_stamp
+      << " scan " << options.ouster_scan_period_ns
+      << " layout " << options.point_layout << " " << options.point_scale
+      << " reduce " << r.ring_step << " " << r.column_step << " " << r.min_range << " " << r.max_range << " " << r.use_box;
+  for(int i = 0 ; i < 3 ; i++) key << " " << r.box_min[i] << " " << r.box_max[i];
+  key << " " << r.voxel_size
+      << " split " << options.split_duration << " " << options.split_bytes << " " << options.split_overlap;
+  return key.str();
+}
+
+// Write range of the selected topics into range.path and its continuation splits, closing a
+// segment and recording the checkpoint every options.checkpoint_period s. With options.resume
+// a bag already completed from the same key is kept and an interrupted one goes on after the
+// last segment it closed.
+bool
+WriteRange(const MulranSequence &sequence, const ExportOptions &options, const ExportRange &range, const std::string &key,
+           int threads, size_t memory_bytes, ExportCounts &counts)
+{
+  ExportCheckpoint checkpoint;
+  const bool loaded = LoadExportCheckpoint(range.path, checkpoint);
+  if(options.resume && loaded && checkpoint.key == key && checkpoint.first == range.first && checkpoint.last == range.last
+    && ExportCheckpointValid(range.path, checkpoint)){
+    if(checkpoint.complete){
+      std::cout << "Already complete: " + range.path + "\n" << std::flush;
+      return true;
+    }
+  }
+  else{
+    // written again from its start, without the continuation splits of the earlier export
+    if(loaded)
+      for(size_t s = 1 ; s < checkpoint.segments.size() ; s++) unlink(ExportSegmentPath(range.path, s).c_str());
+    RemoveExportCheckpoint(range.path);
+    checkpoint.key = key;
+    checkpoint.first = range.first;
+    checkpoint.last = range.last;
+    checkpoint.complete = false;
+    checkpoint.segments.clear();
+  }
+  // the last stamp of each topic written so far, every topic goes on right after it
+  int64_t resume_stamps[NUM_EXPORT_TOPICS] = {-1, -1, -1, -1};
+  if(!checkpoint.segments.empty()){
+    const ExportSegment &last = checkpoint.segments.back();
+    std::copy(last.last_stamp, last.last_stamp + NUM_EXPORT_TOPICS, resume_stamps);
+  }
+
+  // LiDAR scans are decoded concurrently by the workers and come back in stamp order
+  // through a reorder buffer capped at memory_bytes.
+  const StampIndex &ouster_stamps = sequence.ouster_file_stamps_;
+  const bool any_ouster = options.ouster || options.ouster_reduced;
+  size_t ouster_begin, ouster_end;
+  StampRows(ouster_stamps, range.first, range.last, ouster_begin, ouster_end);
+  ouster_begin = ResumeRow(ouster_stamps, ouster_begin, ouster_end, resume_stamps[EXPORT_OUSTER]);
+  if(!any_ouster) ouster_end = ouster_begin;
+  OrderedPipeline<OusterExportFrame> pipeline(
+    ouster_end - ouster_begin,
+    [&](size_t index, OusterExportFrame &frame){
+      if(!LoadOusterScan(sequence.OusterPath(ouster_stamps[ouster_begin + index]), frame.cloud, options.ouster_scan_period_ns))
+        return false;
+      if(options.ouster_reduced){
+        // the workers already run in parallel over scans, each reduces its scan on its own
+        static thread_local ReductionScratch scratch;
+        auto start = std::chrono::steady_clock::now();
+        ReduceCloud(frame.cloud, frame.reduced, options.reduction, scratch);
+        frame.reduce_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+      }
+      if(options.point_layout != POINT_LAYOUT_FULL){
+        static thread_local sensor_msgs::PointCloud2 encoded;
+        EncodeOusterCloud(frame.cloud, encoded, options.point_layout, options.point_scale);
+        std::swap(frame.cloud, encoded);
+        if(options.ouster_reduced){
+          EncodeOusterCloud(frame.reduced, encoded, options.point_layout, options.point_scale);
+          std::swap(frame.reduced, encoded);
+        }
+      }
+      return true;
+    },
+    [](const OusterExportFrame &frame){ return frame.cloud.data.size() + frame.reduced.data.size(); },
+    threads, memory_bytes, 4 * threads);
+
+  // Every topic is merged by stamp, so the bag is written in global time order
+  const ImuTable &imu = sequence.imu_data_;
+  const GpsTable &gps = sequence.gps_data_;
+  size_t imu_begin, imu_end, gps_begin, gps_end, radar_begin, radar_end;
+  StampRows(imu, range.imu_first, range.imu_last, imu_begin, imu_end);
+  StampRows(gps, range.first, range.last, gps_begin, gps_end);
+  StampRows(sequence.radarpolar_file_stamps_, range.first, range.last, radar_begin, radar_end);
+  imu_begin = ResumeRow(imu, imu_begin, imu_end, resume_stamps[EXPORT_IMU]);
+  gps_begin = ResumeRow(gps, gps_begin, gps_end, resume_stamps[EXPORT_GPS]);
+  radar_begin = ResumeRow(sequence.radarpolar_file_stamps_, radar_begin, radar_end, resume_stamps[EXPORT_RADAR]);
+  TableExportStream<ImuTable, sensor_msgs::Imu> imu_stream("/imu/data_raw", imu, imu_begin, imu_end, resume_stamps[EXPORT_IMU]);
+  TableExportStream<GpsTable, sensor_msgs::NavSatFix> gps_stream("/gps/fix", gps, gps_begin, gps_end, resume_stamps[EXPORT_GPS]);
+  OusterExportStream ouster_stream(pipeline, sequence, ouster_begin, options.ouster, options.ouster_reduced,
+                                   resume_stamps[EXPORT_OUSTER]);
+  RadarExportStream radar_stream(sequence, radar_begin, radar_end, resume_stamps[EXPORT_RADAR]);
+  std::vector<ExportStream *> streams;
+  if(options.imu) streams.push_back(&imu_stream);
+  if(options.gps) streams.push_back(&gps_stream);
+  if(any_ouster) streams.push_back(&ouster_stream);
+  if(options.radar) streams.push_back(&radar_stream);
+
+  // One segment per checkpoint period : the merge stops once the period is over, the segment
+  // is closed and recorded, and the streams go on into the next continuation split
+  const auto period = std::chrono::duration<double>(options.checkpoint_period);
+  bool more = true;
+  while(more){
+    const std::string path = ExportSegmentPath(range.path, checkpoint.segments.size());
+    rosbag::Bag bag;
+    try {
+      bag.open(path, rosbag::bagmode::Write);
+    }
+    catch(const rosbag::BagException &e){
+      std::cerr << "Failed to open " << path << " : " << e.what() << std::endl;
+      return false;
+    }
+    if(checkpoint.segments.empty()) std::cout << "Saving data to: " + path + "\n" << std::flush;
+    else std::cout << "Continuing " + range.path + " in: " + path + "\n" << std::flush;
+
+    const auto segment_start = std::chrono::steady_clock::now();
+    std::function<bool()> stop;
+    if(options.checkpoint_period > 0)
+      stop = [&]{ return std::chrono::steady_clock::now() - segment_start >= period; };
+    MergeStreams(streams, bag, stop);
+    bag.close();
+
+    more = false;
+    int64_t stamp;
+    for(size_t i = 0 ; i < streams.size() && !more ; i++) more = streams[i]->Peek(stamp);
+    ExportSegment segment;
+    segment.size = static_cast<uint64_t>(FileBytes(path));
+    segment.last_stamp[EXPORT_IMU] = imu_stream.last_stamp();
+    segment.last_stamp[EXPORT_GPS] = gps_stream.last_stamp();
+    segment.last_stamp[EXPORT_OUSTER] = ouster_stream.last_stamp();
+    segment.last_stamp[EXPORT_RADAR] = radar_stream.last_stamp();
+    checkpoint.segments.push_back(segment);
+    checkpoint.complete = !more;
+    if(!SaveExportCheckpoint(range.path, checkpoint))
+      std::cerr << "Failed to write the checkpoint of " << range.path << std::endl;
+  }
+
+  counts.imu = imu_stream.count();
+  counts.gps = gps_stream.count();
+  counts.ouster_frames = ouster_stream.frame_count();
+  counts.ouster_bytes = ouster_stream.byte_count();
+  counts.reduced_points = ouster_stream.reduced_points();
+  counts.reduce_ns = ouster_stream.reduce_ns();
+  counts.reduce_max_ns = ouster_stream.reduce_max_ns();
+  counts.radar_frames = radar_stream.frame_count();
+  counts.radar_bytes = radar_stream.byte_count();
+  return true;
+}
+
+} // namespace
+
+
+std::string
+SplitBagPath(const std::string &output_path, size_t split)
+{
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), "_%03zu", split);
+  const std::string ext = ".bag";
+  if(output_path.size() >= ext.size() && output_path.compare(output_path.size() - ext.size(), ext.size(), ext) == 0)
+    return output_path.substr(0, output_path.size() - ext.size()) + suffix + ext;
+  return output_path + suffix;
+}
+
+
+// Cut [first, last] into bags of at most options.split_duration of data and about
+// options.split_bytes of payload. Sizes are estimated before anything is written : LiDAR
+// from the point count of each file, radar from the PNG size, IMU / GPS from one message.
+std::vector<ExportRange>
+PlanSplits(const MulranSequence &sequence, const ExportOptions &options, int64_t first, int64_t last)
+{
+  typedef std::pair<int64_t, uint64_t> Item;  // stamp, estimated bytes
+  std::vector<Item> items;
+  const bool by_size = options.split_bytes > 0;
+  size_t begin, end;
+
+  if(options.imu){
+    // IMU samples do not decide the cuts (they are repeated around them), only add their size
+    StampRows(sequence.imu_data_, first, last, begin, end);
+    uint64_t bytes = 0;
+    if(by_size && begin < end){
+      sensor_msgs::Imu msg;
+      sequence.imu_data_.ToMsg(begin, msg);
+      bytes = ros::serialization::serializationLength(msg);
+    }
+    for(size_t i = begin ; i < end ; i++) items.push_back(Item(sequence.imu_data_.stamps_[i], bytes));
+  }
+  if(options.gps){
+    StampRows(sequence.gps_data_, first, last, begin, end);
+    uint64_t bytes = 0;
+    if(by_size && begin < end){
+      sensor_msgs::NavSatFix msg;
+      sequence.gps_data_.ToMsg(begin, msg);
+      bytes = ros::serialization::serializationLength(msg);
+    }
+    for(size_t i = begin ; i < end ; i++) items.push_back(Item(sequence.gps_data_.stamps_[i], bytes));
+  }
+  if(options.ouster || options.ouster_reduced){
+    const StampIndex &stamps = sequence.ouster_file_stamps_;
+    StampRows(stamps, first, last, begin, end);
+    uint64_t step = PointLayoutStep(options.point_layout);
+    // reduced clouds : only the decimation is known up front
+    uint64_t reduced_div = static_cast<uint64_t>(std::max(1, options.reduction.ring_step)) * std::max(1, options.reduction.column_step);
+    for(size_t i = begin ; i < end ; i++){
+      uint64_t bytes = 0;
+      if(by_size){
+        uint64_t points = FileBytes(sequence.OusterPath(stamps[i])) / OUSTER_BIN_POINT_SIZE;
+        if(options.ouster) bytes += points * step;
+        if(options.ouster_reduced) bytes += points * step / reduced_div;
+      }
+      items.push_back(Item(stamps[i], bytes));
+    }
+  }
+  if(options.radar){
+    const StampIndex &stamps = sequence.radarpolar_file_stamps_;
+    StampRows(stamps, first, last, begin, end);
+    for(size_t i = begin ; i < end ; i++)
+      items.push_back(Item(stamps[i], by_size ? FileBytes(sequence.RadarpolarPath(stamps[i])) : 0));
+  }
+  std::sort(items.begin(), items.end());
+
+  std::vector<int64_t> starts;
+  int64_t split_start = first;
+  uint64_t split_bytes = 0;
+  for(size_t i = 0 ; i < items.size() ; i++){
+    if(starts.empty()){
+      split_start = items[i].first;
+      starts.push_back(split_start);
+    }
+    else if((options.split_duration > 0 && items[i].first - split_start >= options.split_duration)
+            || (by_size && split_bytes > 0 && split_bytes + items[i].second > options.split_bytes)){
+      // never between messages of the same stamp
+      if(items[i].first != items[i - 1].first){
+        split_start = items[i].first;
+        starts.push_back(split_start);
+        split_bytes = 0;
+      }
+    }
+    split_bytes += items[i].second;
+  }
+  if(starts.empty()) starts.push_back(first);
+  starts[0] = first;
+
+  std::vector<ExportRange> ranges(starts.size());
+  for(size_t k = 0 ; k < starts.size() ; k++){
+    ExportRange &range = ranges[k];
+    range.first = starts[k];
+    range.last = (k + 1 < starts.size()) ? starts[k + 1] - 1 : last;
+    range.imu_first = (k == 0) ? first : std::max(first, range.first - options.split_overlap);
+    range.imu_last = (k + 1 == starts.size()) ? last : std::min(last, range.last + options.split_overlap);
+    range.path = SplitBagPath(options.output_path, k);
+  }
+  return ranges;
+}
+
+
+bool
+ExportBag(const MulranSequence &sequence, const ExportOptions &options)
+{
+  // an unchanged source exported with the same options is already there
+  const std::string key = SequenceSourceDigest(sequence.data_folder_path_) + " " + OptionsKey(options);
+  ExportManifest manifest;
+  if(options.resume && LoadExportManifest(options.output_path, manifest) && manifest.key == key && ExportManifestValid(manifest)){
+    std::cout << options.output_path << " is up to date (" << manifest.bags.size() << " bags), nothing to export" << std::endl;
+    return true;
+  }
+  RemoveExportManifest(options.output_path);
+
+  auto start_time = std::chrono::steady_clock::now();
+  ExportCounts total;
+  const bool split = options.split_duration > 0 || options.split_bytes > 0;
+  std::vector<ExportRange> ranges;
+
+  if(!split){
+    ExportRange range;
+    range.first = range.imu_first = options.start_stamp;
+    range.last = range.imu_last = options.end_stamp;
+    range.path = options.output_path;
+    ranges.push_back(range);
+    if(!WriteRange(sequence, options, range, key, options.threads, options.memory_bytes, total)) return false;
+  }
+  else{
+    // the splits are independent ranges, each writer thread takes the next one
+    int64_t first = std::max(options.start_stamp, sequence.initial_data_stamp_);
+    int64_t last = std::min(options.end_stamp, sequence.last_data_stamp_);
+    ranges = PlanSplits(sequence, options, first, last);
+    int writers = std::max(1, std::min(options.split_writers, static_cast<int>(ranges.size())));
+    int threads = std::max(1, options.threads / writers);
+    size_t memory_bytes = std::max<size_t>(1, options.memory_bytes / writers);
+    std::cout << "Splitting " << options.output_path << " into " << ranges.size() << " bags, "
+              << writers << " written at once" << std::endl;
+
+    std::vector<ExportCounts> counts(ranges.size());
+    std::atomic<size_t> next_range(0);
+    std::atomic<int> failures(0);
+    std::vector<std::thread> pool;
+    for(int w = 0 ; w < writers ; w++){
+      pool.push_back(std::thread([&]{
+        size_t k;
+        while((k = next_range++) < ranges.size()){
+          if(!WriteRange(sequence, options, ranges[k], key, threads, memory_bytes, counts[k])){
+            failures++;
+            continue;
+          }
+          std::ostringstream line;
+          line << "Split " << k << " saved at: " << ranges[k].path << " ("
+               << (ranges[k].first - sequence.initial_data_stamp_) / 1e9 << " - "
+               << (ranges[k].last - sequence.initial_data_stamp_) / 1e9 << " s, "
+               << counts[k].ouster_frames << " LiDAR frames)\n";
+          std::cout << line.str() << std::flush;
+        }
+      }));
+    }
+    for(auto &th : pool) th.join();
+    for(size_t k = 0 ; k < counts.size() ; k++) total.Add(counts[k]);
+    if(failures > 0) return false;
+  }
+
+  // every bag is closed and checkpointed; the checkpoints stay, so a bag deleted or damaged
+  // later is the only one written again
+  manifest.key = key;
+  manifest.bags.clear();
+  bool complete = true;
+  for(size_t k = 0 ; k < ranges.size() && complete ; k++){
+    ExportCheckpoint checkpoint;
+    complete = LoadExportCheckpoint(ranges[k].path, checkpoint) && checkpoint.complete;
+    for(size_t s = 0 ; complete && s < checkpoint.segments.size() ; s++)
+      manifest.bags.push_back(std::make_pair(ExportSegmentPath(ranges[k].path, s), checkpoint.segments[s].size));
+  }
+  if(complete && !SaveExportManifest(options.output_path, manifest))
+    std::cerr << "Failed to write the manifest of " << options.output_path << std::endl;
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  if(options.imu) std::cout << "IMU data saved (" << total.imu << " messages)." << std::endl;
+  if(options.gps) std::cout << "GPS data saved (" << total.gps << " messages)." << std::endl;
+  if(options.ouster){
+    std::cout << "LiDAR export : " << total.ouster_frames << " frames in " << elapsed << " s ("
+              << total.ouster_frames / std::max(elapsed, 1e-9) << " frames/s, "
+              << total.ouster_bytes / std::max(elapsed, 1e-9) / (1 << 20) << " MB/s, "
+              << options.threads << " decode threads)" << std::endl;
+  }
+  if(options.ouster_reduced && total.ouster_frames > 0){
+    size_t frames = total.ouster_frames;
+    std::cout << "Reduced LiDAR : " << total.reduced_points / frames << " points per frame, reduction "
+              << total.reduce_ns / 1e6 / frames << " ms mean, "
+              << total.reduce_max_ns / 1e6 << " ms max per frame" << std::endl;
+  }
+
+  if(options.radar){
+    std::cout << "Radar data saved (" << total.radar_frames << " frames, "
+              << total.radar_bytes / double(1 << 20) << " MB of PNG)." << std::endl;
+  }
+
+  if(!split){
+    std::cout << "Bag file saved at: " << options.output_path;
+    for(size_t k = 1 ; k < manifest.bags.size() ; k++) std::cout << (k == 1 ? ", continued in: " : ", ") << manifest.bags[k].first;
+    std::cout << std::endl;
+  }
+  return true;
+}
@@ -0,0 +1,268 @@
+#include "file_player/cloudreduction.h"
+
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <string.h>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+using namespace std;
+
+// scans smaller than this per thread are not worth a thread
+#define REDUCTION_MIN_POINTS_PER_THREAD 8192
+
+namespace {
+
+// 21 bits per axis, voxel index offset so negative coordinates stay positive
+inline uint64_t
+VoxelKey(const OusterPoint &p, float inv_size)
+{
+  const int64_t offset = 1 << 20;
+  const int64_t mask = (1 << 21) - 1;
+  int64_t ix = static_cast<int64_t>(floor(p.x * inv_size)) + offset;
+  int64_t iy = static_cast<int64_t>(floor(p.y * inv_size)) + offset;
+  int64_t iz = static_cast<int64_t>(floor(p.z * inv_size)) + offset;
+  return (static_cast<uint64_t>(ix & mask) << 42) | (static_cast<uint64_t>(iy & mask) << 21) | static_cast<uint64_t>(iz & mask);
+}
+
+
+// bijective mix (murmur3 finalizer), so equal hashes mean equal voxels
+inline uint64_t
+HashKey(uint64_t key)
+{
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return key;
+}
+
+
+// decimation and crops over points [begin, end), kept indices (and voxel keys) into part
+void
+FilterPoints(const OusterPoint *points, size_t begin, size_t end, const ReductionOptions &options,
+             ReductionScratch::Part &part)
+{
+  const bool voxel = options.voxel_size > 0.0f;
+  const float inv_size = voxel ? 1.0f / options.voxel_size : 0.0f;
+  const float min2 = options.min_range * options.min_range;
+  const float max2 = options.max_range * options.max_range;
+  const size_t ring_step = max(1, options.ring_step);
+  const size_t column_step = max(1, options.column_step);
+
+  part.kept.clear();
+  part.keys.clear();
+  for(size_t k = begin ; k < end ; k++){
+    if((k % OUSTER_CHANNELS) % ring_step != 0 || (k / OUSTER_CHANNELS) % column_step != 0) continue;
+    const OusterPoint &p = points[k];
+    if(options.min_range > 0.0f || options.max_range > 0.0f){
+      float r2 = p.x*p.x + p.y*p.y + p.z*p.z;
+      if(options.min_range > 0.0f && !(r2 >= min2)) continue;
+      if(options.max_range > 0.0f && !(r2 <= max2)) continue;
+    }
+    if(options.use_box && !(p.x >= options.box_min[0] && p.x <= options.box_max[0]
+                            && p.y >= options.box_min[1] && p.y <= options.box_max[1]
+                            && p.z >= options.box_min[2] && p.z <= options.box_max[2])) continue;
+    if(voxel){
+      if(!(std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z))) continue;
+      part.keys.push_back(HashKey(VoxelKey(p, inv_size)));
+    }
+    part.kept.push_back(static_cast<uint32_t>(k));
+  }
+}
+
+
+// voxels whose key hash falls into this thread's share, in order of first appearance
+void
+AccumulateVoxels(const OusterPoint *points, const vector<ReductionScratch::Part> &parts, size_t num_parts,
+                 size_t share, size_t num_shares, size_t total_kept, ReductionScratch::Part &part)
+{
+  size_t table_size = 16;
+  while(table_size < 2 * total_kept / num_shares + 16) table_size <<= 1;
+  part.table.assign(table_size, -1);
+  part.table_keys.resize(table_size);
+  part.sums.clear();
+  const size_t mask = table_size - 1;
+
+  for(size_t c = 0 ; c < num_parts ; c++){
+    const vector<uint32_t> &kept = parts[c].kept;
+    const vector<uint64_t> &keys = parts[c].keys;
+    for(size_t j = 0 ; j < kept.size() ; j++){
+      if(num_shares > 1 && (keys[j] >> 48) % num_shares != share) continue;
+      size_t slot = static_cast<size_t>(keys[j]) & mask;
+      while(part.table[slot] >= 0 && part.table_keys[slot] != keys[j]) slot = (slot + 1) & mask;
+
+      const OusterPoint &p = points[kept[j]];
+      if(part.table[slot] < 0){
+        part.table[slot] = static_cast<int32_t>(part.sums.size());
+        part.table_keys[slot] = keys[j];
+        ReductionScratch::VoxelSum sum = {p.x, p.y, p.z, p.intensity, 1, kept[j]};
+        part.sums.push_back(sum);
+        continue;
+      }
+      ReductionScratch::VoxelSum &sum = part.sums[part.table[slot]];
+      sum.x += p.x;
+      sum.y += p.y;
+      sum.z += p.z;
+      sum.intensity += p.intensity;
+      sum.count++;
+    }
+  }
+}
+
+
+} // namespace
+
+
+// Threads 1..size-1 of a split scan, waiting between the scans. Run hands every thread the
+// same job and returns once all of them finished it.
+class ReductionWorkers{
+
+public:
+  explicit ReductionWorkers(size_t size)
+    : job_(NULL), num_jobs_(0), pending_(0), generation_(0), active_(true)
+  {
+    for(size_t i = 1 ; i < size ; i ++) threads_.push_back(thread(&ReductionWorkers::Loop, this, i));
+  }
+
+  ~ReductionWorkers(){
+    {
+      lock_guard<mutex> lg(mutex_);
+      active_ = false;
+    }
+    start_cv_.notify_all();
+    for(auto &th : threads_) th.join();
+  }
+
+  size_t size() const { return threads_.size() + 1; }
+
+  // run job(0..n-1) with n <= size(), job 0 on the calling thread
+  void Run(size_t n, const function<void(size_t)> &job){
+    {
+      lock_guard<mutex> lg(mutex_);
+      job_ = &job;
+      num_jobs_ = n;
+      pending_ = n - 1;
+      generation_++;
+    }
+    start_cv_.notify_all();
+    job(0);
+    unique_lock<mutex> ul(mutex_);
+    done_cv_.wait(ul, [&]{ return pending_ == 0; });
+    job_ = NULL;
+  }
+
+private:
+  void Loop(size_t i){
+    size_t seen = 0;
+    unique_lock<mutex> ul(mutex_);
+    while(1){
+      start_cv_.wait(ul, [&]{ return !active_ || generation_ != seen; });
+      if(!active_) return;
+      seen = generation_;
+      if(i >= num_jobs_) continue;
+      const function<void(size_t)> *job = job_;
+      ul.unlock();
+      (*job)(i);
+      ul.lock();
+      if(--pending_ == 0) done_cv_.notify_one();
+    }
+  }
+
+  const function<void(size_t)> *job_;
+  size_t num_jobs_;
+  size_t pending_;
+  size_t generation_;
+  bool active_;
+  mutex mutex_;
+  condition_variable start_cv_;
+  condition_variable done_cv_;
+  vector<thread> threads_;
+};
+
+
+ReductionScratch::ReductionScratch()
+{
+}
+
+
+ReductionScratch::~ReductionScratch()
+{
+}
+
+
+namespace {
+
+// run job(0..n-1) on the workers of scratch, job 0 on the calling thread
+void
+RunParallel(ReductionScratch &scratch, size_t n, const function<void(size_t)> &job)
+{
+  if(n <= 1){
+    job(0);
+    return;
+  }
+  if(!scratch.workers || scratch.workers->size() < n) scratch.workers.reset(new ReductionWorkers(n));
+  scratch.workers->Run(n, job);
+}
+
+} // namespace
+
+
+size_t
+ReduceCloud(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out,
+            const ReductionOptions &options, ReductionScratch &scratch)
+{
+  const size_t num_points = in.point_step == sizeof(OusterPoint) ? in.data.size() / sizeof(OusterPoint) : 0;
+  const OusterPoint *points = reinterpret_cast<const OusterPoint *>(in.data.data());
+
+  //split the scan on column boundaries
+  size_t num_parts = max<size_t>(1, min<size_t>(max(1, options.threads), num_points / REDUCTION_MIN_POINTS_PER_THREAD));
+  if(scratch.parts.size() < num_parts) scratch.parts.resize(num_parts);
+  size_t columns = (num_points + OUSTER_CHANNELS - 1) / OUSTER_CHANNELS;
+  RunParallel(scratch, num_parts, [&](size_t c){
+    size_t begin = min(num_points, columns * c / num_parts * OUSTER_CHANNELS);
+    size_t end = min(num_points, columns * (c + 1) / num_parts * OUSTER_CHANNELS);
+    FilterPoints(points, begin, end, options, scratch.parts[c]);
+  });
+
+  size_t total_kept = 0;
+  for(size_t c = 0 ; c < num_parts ; c++) total_kept += scratch.parts[c].kept.size();
+
+  if(options.voxel_size <= 0.0f){
+    InitOusterCloud(out, total_kept);
+    OusterPoint *dst = reinterpret_cast<OusterPoint *>(out.data.data());
+    vector<size_t> offsets(num_parts, 0);
+    for(size_t c = 1 ; c < num_parts ; c++) offsets[c] = offsets[c-1] + scratch.parts[c-1].kept.size();
+    RunParallel(scratch, num_parts, [&](size_t c){
+      const vector<uint32_t> &kept = scratch.parts[c].kept;
+      for(size_t j = 0 ; j < kept.size() ; j++) dst[offsets[c] + j] = points[kept[j]];
+    });
+    return total_kept;
+  }
+
+  //voxels are shared out by key hash, so every thread owns whole voxels and needs no locks.
+  //The filter parts are only read from here on, the accumulation goes into spare parts.
+  if(scratch.parts.size() < 2 * num_parts) scratch.parts.resize(2 * num_parts);
+  RunParallel(scratch, num_parts, [&](size_t s){
+    AccumulateVoxels(points, scratch.parts, num_parts, s, num_parts, total_kept, scratch.parts[num_parts + s]);
+  });
+
+  size_t num_voxels = 0;
+  for(size_t s = 0 ; s < num_parts ; s++) num_voxels += scratch.parts[num_parts + s].sums.size();
+  InitOusterCloud(out, num_voxels);
+  OusterPoint *dst = reinterpret_cast<OusterPoint *>(out.data.data());
+  for(size_t s = 0 ; s < num_parts ; s++){
+    for(const auto &sum : scratch.parts[num_parts + s].sums){
+      float inv = 1.0f / sum.count;
+      dst->x = sum.x * inv;
+      dst->y = sum.y * inv;
+      dst->z = sum.z * inv;
+      dst->intensity = sum.intensity * inv;
+      dst->t = points[sum.first].t;
+      dst->ring = points[sum.first].ring;
+      dst++;
+    }
+  }
+  return num_voxels;
+}
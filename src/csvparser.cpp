@@ -0,0 +1,362 @@
+#include "file_player/csvparser.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <algorithm>
+
+using namespace std;
+
+// chunks smaller than this are not worth a thread
+#define CSV_MIN_CHUNK_SIZE (1 << 20)
+
+bool
+MappedFile::Open(const string &path)
+{
+  Close();
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0) return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0){
+    close(fd);
+    return false;
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if(size_ == 0){
+    close(fd);
+    return true;
+  }
+
+  void *map = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(map != MAP_FAILED){
+    madvise(map, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char *>(map);
+    mapped_ = true;
+    close(fd);
+    return true;
+  }
+
+  // not mappable (e.g. some network file systems), read it in one go
+  buffer_.resize(size_);
+  size_t done = 0;
+  while(done < size_){
+    ssize_t n = read(fd, buffer_.data() + done, size_ - done);
+    if(n <= 0) break;
+    done += static_cast<size_t>(n);
+  }
+  close(fd);
+  size_ = done;
+  data_ = buffer_.data();
+  return true;
+}
+
+
+void
+MappedFile::Close()
+{
+  if(mapped_) munmap(const_cast<char *>(data_), size_);
+  buffer_.clear();
+  data_ = NULL;
+  size_ = 0;
+  mapped_ = false;
+}
+
+
+static inline const char *
+SkipBlank(const char *p, const char *end)
+{
+  while(p < end && (*p == ' ' || *p == '\t')) p++;
+  return p;
+}
+
+
+const char *
+ParseInt64(const char *p, const char *end, int64_t &value)
+{
+  p = SkipBlank(p, end);
+  bool negative = false;
+  if(p < end && (*p == '-' || *p == '+')){
+    negative = (*p == '-');
+    p++;
+  }
+  const char *digits = p;
+  uint64_t v = 0;
+  while(p < end && static_cast<unsigned>(*p - '0') < 10){
+    v = v*10 + static_cast<unsigned>(*p - '0');
+    p++;
+  }
+  if(p == digits) return NULL;
+  value = negative ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+  return p;
+}
+
+
+// 10^0 .. 10^22 are exact in double
+static const double kPow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+const char *
+ParseDouble(const char *p, const char *end, double &value)
+{
+  p = SkipBlank(p, end);
+  bool negative = false;
+  if(p < end && (*p == '-' || *p == '+')){
+    negative = (*p == '-');
+    p++;
+  }
+
+  // up to 19 significant digits are kept in the mantissa, the rest only move the exponent
+  uint64_t mantissa = 0;
+  int significant = 0;
+  int exponent = 0;
+  bool any_digit = false;
+  while(p < end && static_cast<unsigned>(*p - '0') < 10){
+    any_digit = true;
+    if(significant < 19){
+      mantissa = mantissa*10 + static_cast<unsigned>(*p - '0');
+      if(mantissa != 0) significant++;
+    }
+    else exponent++;
+    p++;
+  }
+  if(p < end && *p == '.'){
+    p++;
+    while(p < end && static_cast<unsigned>(*p - '0') < 10){
+      any_digit = true;
+      if(significant < 19){
+        mantissa = mantissa*10 + static_cast<unsigned>(*p - '0');
+        if(mantissa != 0) significant++;
+        exponent--;
+      }
+      p++;
+    }
+  }
+  if(!any_digit) return NULL;
+
+  if(p < end && (*p == 'e' || *p == 'E')){
+    const char *q = p + 1;
+    bool exp_negative = false;
+    if(q < end && (*q == '-' || *q == '+')){
+      exp_negative = (*q == '-');
+      q++;
+    }
+    if(q < end && static_cast<unsigned>(*q - '0') < 10){
+      int e = 0;
+      while(q < end && static_cast<unsigned>(*q - '0') < 10){
+        if(e < 10000) e = e*10 + (*q - '0');
+        q++;
+      }
+      exponent += exp_negative ? -e : e;
+      p = q;
+    }
+  }
+
+  // exact (correctly rounded) whenever the mantissa fits 53 bits and |exponent| <= 22
+  double v = static_cast<double>(mantissa);
+  if(mantissa == 0 || exponent == 0) {}
+  else if(exponent > 0 && exponent <= 22) v *= kPow10[exponent];
+  else if(exponent < 0 && exponent >= -22) v /= kPow10[-exponent];
+  else v *= pow(10.0, exponent);
+  value = negative ? -v : v;
+  return p;
+}
+
+
+// ',' followed by a number
+static inline bool
+NextDouble(const char *&p, const char *end, double &value)
+{
+  p = SkipBlank(p, end);
+  if(p >= end || *p != ',') return false;
+  p = ParseDouble(p + 1, end, value);
+  return p != NULL;
+}
+
+
+static inline bool
+AtLineEnd(const char *p, const char *end)
+{
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) p++;
+  return p >= end || *p == '\n';
+}
+
+
+static bool
+ParseStampRow(const char *&p, const char *end, StampRow &row)
+{
+  p = ParseInt64(p, end, row.stamp);
+  if(p == NULL || p >= end || *p != ',') return false;
+  p++;
+  const char *name = p;
+  while(p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+  if(p == name) return false;
+  row.name.assign(name, p);
+  return true;
+}
+
+
+static bool
+ParseGpsRow(const char *&p, const char *end, GpsRow &row)
+{
+  p = ParseInt64(p, end, row.stamp);
+  if(p == NULL) return false;
+  if(!NextDouble(p, end, row.latitude) || !NextDouble(p, end, row.longitude) || !NextDouble(p, end, row.altitude))
+    return false;
+  for(int i = 0 ; i < 9 ; i ++)
+    if(!NextDouble(p, end, row.cov[i])) return false;
+  return AtLineEnd(p, end);
+}
+
+
+static bool
+ParseImuRow(const char *&p, const char *end, ImuRow &row)
+{
+  p = ParseInt64(p, end, row.stamp);
+  if(p == NULL) return false;
+  for(int i = 0 ; i < 4 ; i ++)
+    if(!NextDouble(p, end, row.q[i])) return false;
+  for(int i = 0 ; i < 3 ; i ++)
+    if(!NextDouble(p, end, row.euler[i])) return false;
+  row.fields = 8;
+  if(AtLineEnd(p, end)){
+    // orientation only : no stale values of a previous full row
+    fill(row.gyro, row.gyro + 3, 0.0);
+    fill(row.acc, row.acc + 3, 0.0);
+    fill(row.mag, row.mag + 3, 0.0);
+    return true;
+  }
+
+  double *rest[9] = {&row.gyro[0], &row.gyro[1], &row.gyro[2],
+                     &row.acc[0], &row.acc[1], &row.acc[2],
+                     &row.mag[0], &row.mag[1], &row.mag[2]};
+  for(int i = 0 ; i < 9 ; i ++)
+    if(!NextDouble(p, end, *rest[i])) return false;
+  row.fields = 17;
+  return AtLineEnd(p, end);
+}
+
+
+// Parse [begin, end) line by line, stop at the first malformed line
+template <typename Row, typename ParseRow>
+static bool
+ParseLines(const char *begin, const char *end, ParseRow parse_row, vector<Row> &rows)
+{
+  const char *p = begin;
+  Row row = Row();
+  while(1){
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) p++;
+    if(p >= end) return true;
+    if(!parse_row(p, end, row)) return false;
+    rows.push_back(row);
+    while(p < end && *p != '\n') p++;
+  }
+}
+
+
+template <typename Row, typename ParseRow>
+static bool
+ParseCsv(const string &path, ParseRow parse_row, vector<Row> &rows, int num_threads)
+{
+  rows.clear();
+  MappedFile file;
+  if(!file.Open(path)) return false;
+  const char *data = file.data();
+  size_t size = file.size();
+  if(size == 0) return true;
+
+  if(num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+  size_t chunks = min(static_cast<size_t>(num_threads), max<size_t>(1, size / CSV_MIN_CHUNK_SIZE));
+
+  // chunk i is [bounds[i], bounds[i+1]), every bound but the first sits right after a '\n'
+  vector<const char *> bounds(chunks + 1);
+  bounds[0] = data;
+  bounds[chunks] = data + size;
+  for(size_t i = 1 ; i < chunks ; i ++){
+    const char *p = max(data + size*i/chunks, bounds[i-1]);
+    while(p < data + size && *p != '\n') p++;
+    bounds[i] = (p < data + size) ? p + 1 : data + size;
+  }
+
+  vector<vector<Row> > parts(chunks);
+  vector<char> complete(chunks, 1);
+  vector<thread> threads;
+  for(size_t i = 1 ; i < chunks ; i ++){
+    threads.push_back(thread([&, i]{
+      parts[i].reserve((bounds[i+1] - bounds[i]) / 64);
+      complete[i] = ParseLines(bounds[i], bounds[i+1], parse_row, parts[i]);
+    }));
+  }
+  complete[0] = ParseLines(bounds[0], bounds[1], parse_row, parts[0]);
+  for(auto &th : threads) th.join();
+
+  size_t total = 0;
+  for(size_t i = 0 ; i < chunks ; i ++){
+    total += parts[i].size();
+    if(!complete[i]) break;
+  }
+  rows.reserve(total);
+  for(size_t i = 0 ; i < chunks ; i ++){
+    rows.insert(rows.end(), parts[i].begin(), parts[i].end());
+    if(!complete[i]) break;
+  }
+  return true;
+}
+
+
+bool
+ParseDataStampCsv(const string &path, vector<StampRow> &rows, int num_threads)
+{
+  return ParseCsv(path, ParseStampRow, rows, num_threads);
+}
+
+
+bool
+ParseGpsCsv(const string &path, vector<GpsRow> &rows, int num_threads)
+{
+  return ParseCsv(path, ParseGpsRow, rows, num_threads);
+}
+
+
+bool
+ParseImuCsv(const string &path, vector<ImuRow> &rows, int num_threads)
+{
+  return ParseCsv(path, ParseImuRow, rows, num_threads);
+}
+
+
+vector<int>
+ShareCsvThreads(const vector<string> &paths, int num_threads)
+{
+  if(num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+  vector<uint64_t> sizes(paths.size(), 0);
+  uint64_t total = 0;
+  for(size_t i = 0 ; i < paths.size() ; i ++){
+    struct stat st;
+    if(stat(paths[i].c_str(), &st) == 0) sizes[i] = static_cast<uint64_t>(st.st_size);
+    total += sizes[i];
+  }
+
+  // one thread each, the rest goes by size with the remainders to the largest files
+  vector<int> shares(paths.size(), 1);
+  int spare = num_threads - static_cast<int>(paths.size());
+  if(spare <= 0 || total == 0) return shares;
+  vector<pair<uint64_t, size_t> > remainders;
+  int given = 0;
+  for(size_t i = 0 ; i < paths.size() ; i ++){
+    uint64_t scaled = sizes[i] * static_cast<uint64_t>(spare);
+    shares[i] += static_cast<int>(scaled / total);
+    given += static_cast<int>(scaled / total);
+    remainders.push_back(make_pair(scaled % total, i));
+  }
+  sort(remainders.rbegin(), remainders.rend());
+  for(size_t i = 0 ; given < spare && i < remainders.size() ; i ++, given ++) shares[remainders[i].second]++;
+  return shares;
+}
@@ -0,0 +1,173 @@
+#include "file_player/exportcheckpoint.h"
+#include "file_player/bagexporter.h"
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+
+const char kCheckpointMagic[] = "file_player export checkpoint 3";
+const char kManifestMagic[] = "file_player export manifest 1";
+
+bool
+FileSize(const string &path, uint64_t &size)
+{
+  struct stat st;
+  if(stat(path.c_str(), &st) != 0) return false;
+  size = static_cast<uint64_t>(st.st_size);
+  return true;
+}
+
+// write to a temporary file and rename it over path, so path is always whole
+bool
+WriteFileAtomic(const string &path, const string &data)
+{
+  const string tmp_path = path + ".tmp";
+  FILE *fp = fopen(tmp_path.c_str(), "wb");
+  if(fp == NULL) return false;
+  bool ok = data.empty() || fwrite(data.data(), 1, data.size(), fp) == data.size();
+  ok = (fflush(fp) == 0) && (fsync(fileno(fp)) == 0) && ok;
+  ok = (fclose(fp) == 0) && ok;
+  if(!ok || rename(tmp_path.c_str(), path.c_str()) != 0){
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+} // namespace
+
+
+string
+ExportSegmentPath(const string &bag_path, size_t segment)
+{
+  return (segment == 0) ? bag_path : SplitBagPath(bag_path, segment);
+}
+
+
+bool
+SaveExportCheckpoint(const string &bag_path, const ExportCheckpoint &checkpoint)
+{
+  ostringstream text;
+  text << kCheckpointMagic << "\n"
+       << "key " << checkpoint.key << "\n"
+       << "range " << checkpoint.first << " " << checkpoint.last << "\n";
+  for(size_t s = 0 ; s < checkpoint.segments.size() ; s ++){
+    // segment <size> <last stamp of every topic>
+    const ExportSegment &segment = checkpoint.segments[s];
+    text << "segment " << segment.size;
+    for(int t = 0 ; t < NUM_EXPORT_TOPICS ; t ++) text << " " << segment.last_stamp[t];
+    text << "\n";
+  }
+  text << "complete " << (checkpoint.complete ? 1 : 0) << "\n";
+  return WriteFileAtomic(bag_path + EXPORT_CHECKPOINT_SUFFIX, text.str());
+}
+
+
+bool
+LoadExportCheckpoint(const string &bag_path, ExportCheckpoint &checkpoint)
+{
+  ifstream in((bag_path + EXPORT_CHECKPOINT_SUFFIX).c_str());
+  string line;
+  if(!getline(in, line) || line != kCheckpointMagic) return false;
+
+  checkpoint.segments.clear();
+  int found = 0;  // one bit per line
+  while(getline(in, line)){
+    istringstream fields(line);
+    string name;
+    fields >> name;
+    if(name == "key"){
+      checkpoint.key = line.size() > 4 ? line.substr(4) : string();
+      found |= 1;
+    }
+    else if(name == "range" && (fields >> checkpoint.first >> checkpoint.last)) found |= 2;
+    else if(name == "segment"){
+      ExportSegment segment;
+      if(!(fields >> segment.size)) return false;
+      for(int t = 0 ; t < NUM_EXPORT_TOPICS ; t ++)
+        if(!(fields >> segment.last_stamp[t])) return false;
+      checkpoint.segments.push_back(segment);
+    }
+    else if(name == "complete" && (fields >> checkpoint.complete)) found |= 4;
+  }
+  // a complete bag has at least one segment
+  return found == 7 && !(checkpoint.complete && checkpoint.segments.empty());
+}
+
+
+bool
+ExportCheckpointValid(const string &bag_path, const ExportCheckpoint &checkpoint)
+{
+  for(size_t s = 0 ; s < checkpoint.segments.size() ; s ++){
+    uint64_t size;
+    if(!FileSize(ExportSegmentPath(bag_path, s), size) || size != checkpoint.segments[s].size) return false;
+  }
+  return true;
+}
+
+
+void
+RemoveExportCheckpoint(const string &bag_path)
+{
+  unlink((bag_path + EXPORT_CHECKPOINT_SUFFIX).c_str());
+}
+
+
+bool
+SaveExportManifest(const string &output_path, const ExportManifest &manifest)
+{
+  ostringstream text;
+  text << kManifestMagic << "\n"
+       << "key " << manifest.key << "\n";
+  for(size_t i = 0 ; i < manifest.bags.size() ; i ++)
+    text << "bag " << manifest.bags[i].second << " " << manifest.bags[i].first << "\n";
+  return WriteFileAtomic(output_path + EXPORT_MANIFEST_SUFFIX, text.str());
+}
+
+
+bool
+LoadExportManifest(const string &output_path, ExportManifest &manifest)
+{
+  ifstream in((output_path + EXPORT_MANIFEST_SUFFIX).c_str());
+  string line;
+  if(!getline(in, line) || line != kManifestMagic) return false;
+  if(!getline(in, line) || line.compare(0, 4, "key ") != 0) return false;
+  manifest.key = line.substr(4);
+  manifest.bags.clear();
+  while(getline(in, line)){
+    // bag <size> <path>
+    istringstream fields(line);
+    string name;
+    uint64_t size;
+    if(!(fields >> name >> size) || name != "bag") return false;
+    fields.get();
+    string path;
+    getline(fields, path);
+    manifest.bags.push_back(make_pair(path, size));
+  }
+  return !manifest.bags.empty();
+}
+
+
+void
+RemoveExportManifest(const string &output_path)
+{
+  unlink((output_path + EXPORT_MANIFEST_SUFFIX).c_str());
+}
+
+
+bool
+ExportManifestValid(const ExportManifest &manifest)
+{
+  for(size_t i = 0 ; i < manifest.bags.size() ; i ++){
+    uint64_t size;
+    if(!FileSize(manifest.bags[i].first, size) || size != manifest.bags[i].second) return false;
+  }
+  return true;
+}
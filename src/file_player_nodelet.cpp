@@ -0,0 +1,66 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <thread>
+
+#include "file_player/playerengine.h"
+
+namespace file_player
+{
+
+// Headless player loaded into a nodelet manager. Every message is published as a
+// shared_ptr to const, so nodelets in the same manager receive the pointer itself :
+// no serialization and no copy of the clouds and images.
+class PlayerNodelet : public nodelet::Nodelet, public PlayerEngine
+{
+
+public:
+  ~PlayerNodelet()
+  {
+    if(ready_thread_.joinable()) ready_thread_.join();
+    Shutdown();
+  }
+
+private:
+  void onInit()
+  {
+    ros::NodeHandle &nh = getNodeHandle();
+    const ros::NodeHandle &private_nh = getPrivateNodeHandle();
+
+    std::string data_folder;
+    bool autoplay;
+    double rate;
+    private_nh.param("data_folder", data_folder, std::string(""));
+    private_nh.param("autoplay", autoplay, true);
+    private_nh.param("rate", rate, 1.0);
+    private_nh.param("loop", loop_flag_, false);
+
+    ros_initialize(nh, private_nh);
+    SetPlayRate(rate);
+    if(data_folder.empty())
+    {
+      NODELET_ERROR("file_player : ~data_folder is not set, nothing to play");
+      return;
+    }
+    data_folder_path_ = data_folder;
+    //the sequence is loaded off the manager's init thread, the other nodelets of the
+    //manager do not wait for the CSV parse and the read-ahead start
+    ready_thread_ = std::thread([this, autoplay, data_folder, rate]{
+      Ready();
+      //the callback queue of the manager serves /file_player_start and /file_player_stop
+      if(autoplay) SetPlayFlag(true);
+      NODELET_INFO_STREAM("file_player : playing " << data_folder << " at x" << rate);
+    });
+  }
+
+  void OnStats(const std::string &text)
+  {
+    NODELET_DEBUG_STREAM(text);
+  }
+
+  std::thread ready_thread_;
+};
+
+} // namespace file_player
+
+PLUGINLIB_EXPORT_CLASS(file_player::PlayerNodelet, nodelet::Nodelet)
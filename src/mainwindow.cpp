@@ -19,6 +19,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
   connect(my_ros_, SIGNAL(StampShow(quint64)), this, SLOT(SetStamp(quint64)));
   connect(my_ros_, SIGNAL(StartSignal()), this, SLOT(Play()));
+  connect(my_ros_, SIGNAL(StatsShow(QString)), this, SLOT(SetStats(QString)));
 
   connect(ui_->quitButton, SIGNAL(pressed()), this, SLOT(TryClose()));
   connect(ui_->pushButton, SIGNAL(pressed()), this, SLOT(FilePathSet()));
@@ -75,6 +76,14 @@ MainWindow::~MainWindow()
 void MainWindow::RosInit(ros::NodeHandle &n)
 {
   my_ros_->ros_initialize(n);
+
+  //~lockstep param sets the initial mode
+  if(my_ros_->lockstep_flag_ == true){
+    ui_->checkBox_4->setCheckState(Qt::Checked);
+  }else{
+    ui_->checkBox_4->setCheckState(Qt::Unchecked);
+  }
+  connect(ui_->checkBox_4, SIGNAL(stateChanged(int)), this, SLOT (LockstepFlagChange(int)));
 }
 
 
@@ -87,11 +96,11 @@ void MainWindow::TryClose()
 void MainWindow::FilePathSet()
 {
   play_flag_ = false;
-  my_ros_->play_flag_ = false;
+  my_ros_->SetPlayFlag(false);
   this->ui_->pushButton_2->setText(QString::fromStdString("Play"));
 
   pause_flag_ = false;
-  my_ros_->pause_flag_ = false;
+  my_ros_->SetPauseFlag(false);
   this->ui_->pushButton_3->setText(QString::fromStdString("Pause"));
 
   QFileDialog dialog;
@@ -111,24 +120,31 @@ void MainWindow::SetStamp(quint64 stamp)
 
   //set slide bar
   if(slider_checker_ == false){
-    ui_->horizontalSlider->setValue(static_cast<int>(static_cast<float>(stamp - my_ros_->initial_data_stamp_)/static_cast<float>(my_ros_->last_data_stamp_ - my_ros_->initial_data_stamp_)*10000));
+    int64_t length = my_ros_->last_data_stamp_ - my_ros_->initial_data_stamp_;
+    if(length > 0)
+      ui_->horizontalSlider->setValue(static_cast<int>((static_cast<int64_t>(stamp) - my_ros_->initial_data_stamp_) * 10000 / length));
   }
 }
 
+void MainWindow::SetStats(QString text)
+{
+  this->ui_->label_5->setText(text);
+}
+
 void MainWindow::Play()
 {
   if(my_ros_->play_flag_ == false){
     play_flag_ = true;
-    my_ros_->play_flag_ = true;
+    my_ros_->SetPlayFlag(true);
     this->ui_->pushButton_2->setText(QString::fromStdString("End"));
 
     pause_flag_ = false;
-    my_ros_->pause_flag_ = false;
+    my_ros_->SetPauseFlag(false);
     this->ui_->pushButton_3->setText(QString::fromStdString("Pause"));
 
   }else{
     play_flag_ = false;
-    my_ros_->play_flag_ = false;
+    my_ros_->SetPlayFlag(false);
     this->ui_->pushButton_2->setText(QString::fromStdString("Play"));
   }
 }
@@ -137,11 +153,11 @@ void MainWindow::Pause()
 {
   if(pause_flag_ == false){
     pause_flag_ = true;
-    my_ros_->pause_flag_ = true;
+    my_ros_->SetPauseFlag(true);
     this->ui_->pushButton_3->setText(QString::fromStdString("Resume"));
   }else{
     pause_flag_ = false;
-    my_ros_->pause_flag_ = false;
+    my_ros_->SetPauseFlag(false);
     this->ui_->pushButton_3->setText(QString::fromStdString("Pause"));
   }
 }
@@ -158,7 +174,7 @@ void MainWindow::SaveBag()
 
 void MainWindow::PlaySpeedChange(double value)
 {
-  my_ros_->play_rate_ = value;
+  my_ros_->SetPlayRate(value);
 }
 
 void MainWindow::LoopFlagChange(int value)
@@ -189,6 +205,14 @@ void MainWindow::AutoStartFlagChange(int value)
     my_ros_->auto_start_flag_ = false;
   }
 }
+void MainWindow::LockstepFlagChange(int value)
+{
+  if(value == 2){
+    my_ros_->SetLockstepFlag(true);
+  }else if(value == 0){
+    my_ros_->SetLockstepFlag(false);
+  }
+}
 void MainWindow::SliderValueChange(int value)
 {
   slider_value_ = value;
@@ -58,7 +58,9 @@ private slots:
   void LoopFlagChange(int value);
   void StopSkipFlagChange(int value);
   void AutoStartFlagChange(int value);
+  void LockstepFlagChange(int value);
   void SetStamp(quint64 stamp);
+  void SetStats(QString text);
   void SliderValueChange(int value);
   void SliderPressed();
   void SliderValueApply();
@@ -0,0 +1,190 @@
+// Headless MulRan -> rosbag converter, no Qt and no ROS master needed.
+//
+//   mulran_export [options] <sequence_dir> [<sequence_dir> ...]
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ros/time.h>
+
+#include "file_player/sequence.h"
+#include "file_player/bagexporter.h"
+
+using namespace std;
+
+static void
+PrintUsage(const char *name)
+{
+  cout << "Usage: " << name << " [options] <sequence_dir> [<sequence_dir> ...]" << endl
+       << "  --topics <list>    comma separated subset of imu,gps,ouster,ouster_reduced,radar (default imu,ouster)" << endl
+       << "  --start <sec>      skip data before <sec> seconds from the sequence start" << endl
+       << "  --end <sec>        skip data after <sec> seconds from the sequence start" << endl
+       << "  --output <name>    bag file name inside each sequence directory (default imu_lidar_output.bag)" << endl
+       << "  --jobs <n>         sequences converted concurrently (default 1)" << endl
+       << "  --threads <n>      CSV parse and LiDAR decode threads shared by all jobs (default: all cores)" << endl
+       << "  --memory-mb <n>    decoded-scan buffer memory shared by all jobs (default 2048)" << endl
+       << "  --scan-period <s>  LiDAR rotation period the per-point time is spread over (default 0.1)" << endl
+       << "  --point-layout <l> LiDAR point layout : full (24 B), xyzi (16 B), xyzirt (22 B), xyz16 (8 B) (default full)" << endl
+       << "  --point-scale <m>  xyz16 quantization step (default 0.005)" << endl
+       << "  --no-cache         neither read nor write sensor_data/.file_player_cache" << endl
+       << "  Split into <output>_000.bag, <output>_001.bag, ... (off by default) :" << endl
+       << "  --split-duration <sec>     at most <sec> seconds of data per bag" << endl
+       << "  --split-size-mb <n>        about <n> MB of messages per bag" << endl
+       << "  --split-overlap <sec>      IMU repeated on both sides of every boundary (default 1)" << endl
+       << "  --split-writers <n>        bags written at once, sharing the job's threads (default 2)" << endl
+       << "  Interrupted exports go on after their last checkpoint, finished exports are skipped :" << endl
+       << "  --checkpoint <sec>         close the bag and go on in <bag>_001.bag, ... every <sec> s (default 60, 0 : off)" << endl
+       << "  --restart                  ignore checkpoints and manifests, write everything again" << endl
+       << "  /os1_points_reduced stages (off by default) :" << endl
+       << "  --reduce-rings <n>         keep every n-th beam" << endl
+       << "  --reduce-columns <n>       keep every n-th firing column" << endl
+       << "  --reduce-range <min,max>   keep min <= range <= max [m], 0 for no bound" << endl
+       << "  --reduce-box <x0,y0,z0,x1,y1,z1>  keep points inside the box [m]" << endl
+       << "  --reduce-voxel <size>      one centroid per voxel of size [m]" << endl;
+}
+
+
+static bool
+ParseTopics(const string &list, ExportOptions &options)
+{
+  options.imu = options.gps = options.ouster = options.ouster_reduced = options.radar = false;
+  size_t begin = 0;
+  while(begin <= list.size()){
+    size_t end = list.find(',', begin);
+    if(end == string::npos) end = list.size();
+    string topic = list.substr(begin, end - begin);
+    if(topic == "imu") options.imu = true;
+    else if(topic == "gps") options.gps = true;
+    else if(topic == "ouster") options.ouster = true;
+    else if(topic == "ouster_reduced") options.ouster_reduced = true;
+    else if(topic == "radar") options.radar = true;
+    else{
+      cerr << "Unknown topic : " << topic << endl;
+      return false;
+    }
+    begin = end + 1;
+  }
+  return true;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  ExportOptions base_options;
+  string output_name = "imu_lidar_output.bag";
+  double start_sec = -1.0;
+  double end_sec = -1.0;
+  int jobs = 1;
+  int threads = max(1u, std::thread::hardware_concurrency());
+  int memory_mb = 2048;
+  bool use_cache = true;
+  vector<string> sequences;
+
+  for(int i = 1 ; i < argc ; i ++){
+    string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if(arg == "-h" || arg == "--help"){
+      PrintUsage(argv[0]);
+      return 0;
+    }
+    else if(arg == "--topics" && has_value){
+      if(!ParseTopics(argv[++i], base_options)) return 1;
+    }
+    else if(arg == "--start" && has_value) start_sec = atof(argv[++i]);
+    else if(arg == "--end" && has_value) end_sec = atof(argv[++i]);
+    else if(arg == "--output" && has_value) output_name = argv[++i];
+    else if(arg == "--jobs" && has_value) jobs = max(1, atoi(argv[++i]));
+    else if(arg == "--threads" && has_value) threads = max(1, atoi(argv[++i]));
+    else if(arg == "--memory-mb" && has_value) memory_mb = max(1, atoi(argv[++i]));
+    else if(arg == "--scan-period" && has_value) base_options.ouster_scan_period_ns = static_cast<uint32_t>(max(0.0, atof(argv[++i])) * 1e9);
+    else if(arg == "--no-cache") use_cache = false;
+    else if(arg == "--split-duration" && has_value) base_options.split_duration = static_cast<int64_t>(max(0.0, atof(argv[++i])) * 1e9);
+    else if(arg == "--split-size-mb" && has_value) base_options.split_bytes = static_cast<uint64_t>(max(0.0, atof(argv[++i])) * (1 << 20));
+    else if(arg == "--split-overlap" && has_value) base_options.split_overlap = static_cast<int64_t>(max(0.0, atof(argv[++i])) * 1e9);
+    else if(arg == "--split-writers" && has_value) base_options.split_writers = max(1, atoi(argv[++i]));
+    else if(arg == "--checkpoint" && has_value) base_options.checkpoint_period = max(0.0, atof(argv[++i]));
+    else if(arg == "--restart") base_options.resume = false;
+    else if(arg == "--point-layout" && has_value){
+      if(!ParsePointLayout(argv[++i], base_options.point_layout)){
+        cerr << "Unknown point layout : " << argv[i] << endl;
+        return 1;
+      }
+    }
+    else if(arg == "--point-scale" && has_value) base_options.point_scale = static_cast<float>(atof(argv[++i]));
+    else if(arg == "--reduce-rings" && has_value) base_options.reduction.ring_step = max(1, atoi(argv[++i]));
+    else if(arg == "--reduce-columns" && has_value) base_options.reduction.column_step = max(1, atoi(argv[++i]));
+    else if(arg == "--reduce-voxel" && has_value) base_options.reduction.voxel_size = static_cast<float>(atof(argv[++i]));
+    else if(arg == "--reduce-range" && has_value){
+      ReductionOptions &reduction = base_options.reduction;
+      if(sscanf(argv[++i], "%f,%f", &reduction.min_range, &reduction.max_range) != 2){
+        cerr << "--reduce-range takes <min>,<max>" << endl;
+        return 1;
+      }
+    }
+    else if(arg == "--reduce-box" && has_value){
+      ReductionOptions &reduction = base_options.reduction;
+      reduction.use_box = true;
+      if(sscanf(argv[++i], "%f,%f,%f,%f,%f,%f", &reduction.box_min[0], &reduction.box_min[1], &reduction.box_min[2],
+                &reduction.box_max[0], &reduction.box_max[1], &reduction.box_max[2]) != 6){
+        cerr << "--reduce-box takes <x0>,<y0>,<z0>,<x1>,<y1>,<z1>" << endl;
+        return 1;
+      }
+    }
+    else if(arg.compare(0, 2, "--") == 0){
+      cerr << "Unknown or incomplete option : " << arg << endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    else sequences.push_back(arg);
+  }
+
+  if(sequences.empty()){
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  ros::Time::init();
+
+  // the thread and memory budgets are split evenly between the concurrent jobs, the CSV
+  // parse of each sequence uses its job's share of the threads as well
+  jobs = min(jobs, static_cast<int>(sequences.size()));
+  base_options.threads = max(1, threads / jobs);
+  base_options.memory_bytes = max<size_t>(1, (static_cast<size_t>(memory_mb) << 20) / jobs);
+
+  atomic<size_t> next_sequence(0);
+  atomic<int> failures(0);
+  vector<thread> workers;
+  for(int j = 0 ; j < jobs ; j ++){
+    workers.push_back(thread([&]{
+      size_t index;
+      while((index = next_sequence++) < sequences.size()){
+        const string &dir = sequences[index];
+        MulranSequence sequence;
+        sequence.use_cache_ = use_cache;
+        if(!sequence.Load(dir, base_options.imu, base_options.threads)){
+          cerr << "Failed to load " << dir << endl;
+          failures++;
+          continue;
+        }
+
+        ExportOptions options = base_options;
+        options.output_path = dir + "/" + output_name;
+        int64_t first_stamp = sequence.initial_data_stamp_ + 1;
+        if(start_sec >= 0.0) options.start_stamp = first_stamp + static_cast<int64_t>(start_sec * 1e9);
+        if(end_sec >= 0.0) options.end_stamp = first_stamp + static_cast<int64_t>(end_sec * 1e9);
+
+        if(!ExportBag(sequence, options)) failures++;
+      }
+    }));
+  }
+  for(auto &worker : workers) worker.join();
+
+  cout << sequences.size() - failures << " of " << sequences.size() << " sequences exported" << endl;
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+// Native replacement of utils/mulran2oxfordFormat.m : converts the radar/ray/*.csv scans of
+// MulRan sequences into Oxford-format polar PNGs, one file per worker at a time.
+//
+//   mulran_ray2oxford [options] <sequence_dir> [<sequence_dir> ...]
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "file_player/sequence.h"
+#include "file_player/radarray.h"
+
+using namespace std;
+
+static void
+PrintUsage(const char *name)
+{
+  cout << "Usage: " << name << " [options] <sequence_dir> [<sequence_dir> ...]" << endl
+       << "  reads <sequence_dir>/sensor_data/radar/ray/<stamp>.csv" << endl
+       << "  writes <sequence_dir>/sensor_data/radar/<output>/<stamp>.png" << endl
+       << "  --output <name>    output directory name (default oxford_form)" << endl
+       << "  --jobs <n>         files converted concurrently (default: all cores)" << endl
+       << "  --skip-existing    keep PNGs that are already there" << endl;
+}
+
+
+struct ConvertJob{
+  string csv_path;
+  string png_path;
+};
+
+
+// encode, write next to the target and rename, so an interrupted run leaves no truncated PNG
+static bool
+WritePng(const string &path, const cv::Mat &image, vector<uint8_t> &buffer)
+{
+  if(!cv::imencode(".png", image, buffer)) return false;
+  const string tmp_path = path + ".tmp";
+  FILE *fp = fopen(tmp_path.c_str(), "wb");
+  if(fp == NULL) return false;
+  bool ok = fwrite(buffer.data(), 1, buffer.size(), fp) == buffer.size();
+  ok = (fclose(fp) == 0) && ok;
+  if(!ok || rename(tmp_path.c_str(), path.c_str()) != 0){
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+  string output_name = "oxford_form";
+  int jobs = max(1u, std::thread::hardware_concurrency());
+  bool skip_existing = false;
+  vector<string> sequences;
+
+  for(int i = 1 ; i < argc ; i ++){
+    string arg = argv[i];
+    bool has_value = (i + 1 < argc);
+    if(arg == "-h" || arg == "--help"){
+      PrintUsage(argv[0]);
+      return 0;
+    }
+    else if(arg == "--output" && has_value) output_name = argv[++i];
+    else if(arg == "--jobs" && has_value) jobs = max(1, atoi(argv[++i]));
+    else if(arg == "--skip-existing") skip_existing = true;
+    else if(arg.compare(0, 2, "--") == 0){
+      cerr << "Unknown or incomplete option : " << arg << endl;
+      PrintUsage(argv[0]);
+      return 1;
+    }
+    else sequences.push_back(arg);
+  }
+
+  if(sequences.empty()){
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  //every file of every sequence goes into one work list, so small sequences do not leave cores idle
+  vector<ConvertJob> work;
+  size_t skipped = 0;
+  for(const auto &dir : sequences){
+    const string radar_dir = dir + "/sensor_data/radar";
+    StampIndex files;
+    if(GetDirList(radar_dir + "/ray", files) != 0 || files.empty()) continue;
+    const string save_dir = radar_dir + "/" + output_name;
+    if(mkdir(save_dir.c_str(), 0755) != 0 && errno != EEXIST){
+      perror(save_dir.c_str());
+      return 1;
+    }
+    for(size_t i = 0 ; i < files.size() ; i ++){
+      ConvertJob job;
+      job.csv_path = radar_dir + "/ray/" + to_string(files[i]) + ".csv";
+      job.png_path = save_dir + "/" + to_string(files[i]) + ".png";
+      struct stat st;
+      if(skip_existing && stat(job.png_path.c_str(), &st) == 0){
+        skipped++;
+        continue;
+      }
+      work.push_back(job);
+    }
+  }
+
+  auto start_time = chrono::steady_clock::now();
+  jobs = max(1, min(jobs, static_cast<int>(work.size())));
+  atomic<size_t> next_job(0);
+  atomic<size_t> done(0);
+  atomic<int> failures(0);
+  vector<thread> workers;
+  for(int j = 0 ; j < jobs ; j ++){
+    workers.push_back(thread([&]{
+      cv::Mat image;
+      vector<uint8_t> buffer;
+      size_t index;
+      while((index = next_job++) < work.size()){
+        const ConvertJob &job = work[index];
+        if(!LoadRadarRayCsv(job.csv_path, image) || !WritePng(job.png_path, image, buffer)){
+          cerr << "Failed to convert " << job.csv_path << endl;
+          failures++;
+          continue;
+        }
+        size_t count = ++done;
+        if(count % 1000 == 0) cout << count << " / " << work.size() << " files converted" << endl;
+      }
+    }));
+  }
+  for(auto &worker : workers) worker.join();
+
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+  cout << done << " files converted in " << elapsed << " s (" << done / max(elapsed, 1e-9) << " files/s, "
+       << jobs << " jobs)";
+  if(skipped) cout << ", " << skipped << " already there";
+  cout << endl;
+  return failures == 0 ? 0 : 1;
+}
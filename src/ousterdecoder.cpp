@@ -0,0 +1,85 @@
+#include "file_player/ousterdecoder.h"
+#include "file_player/pointfields.h"
+
+#include <iostream>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+static sensor_msgs::PointField
+MakeField(const string &name, uint32_t offset, uint8_t datatype)
+{
+  sensor_msgs::PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  return field;
+}
+
+
+void
+InitOusterCloud(sensor_msgs::PointCloud2 &cloud, size_t num_points)
+{
+  if(cloud.fields.size() != 6){
+    cloud.fields.clear();
+    cloud.fields.push_back(MakeField("x", offsetof(OusterPoint, x), sensor_msgs::PointField::FLOAT32));
+    cloud.fields.push_back(MakeField("y", offsetof(OusterPoint, y), sensor_msgs::PointField::FLOAT32));
+    cloud.fields.push_back(MakeField("z", offsetof(OusterPoint, z), sensor_msgs::PointField::FLOAT32));
+    cloud.fields.push_back(MakeField("intensity", offsetof(OusterPoint, intensity), sensor_msgs::PointField::FLOAT32));
+    cloud.fields.push_back(MakeField("t", offsetof(OusterPoint, t), sensor_msgs::PointField::UINT32));
+    cloud.fields.push_back(MakeField("ring", offsetof(OusterPoint, ring), sensor_msgs::PointField::INT32));
+  }
+  cloud.height = 1;
+  cloud.width = num_points;
+  cloud.is_bigendian = false;
+  cloud.is_dense = true;
+  cloud.point_step = sizeof(OusterPoint);
+  cloud.row_step = cloud.point_step * cloud.width;
+  cloud.data.resize(static_cast<size_t>(cloud.row_step));
+}
+
+
+bool
+LoadOusterScan(const string &file_path, sensor_msgs::PointCloud2 &cloud, uint32_t scan_period_ns)
+{
+  int fd = open(file_path.c_str(), O_RDONLY);
+  if(fd < 0){
+    perror(file_path.c_str());
+    return false;
+  }
+
+  struct stat st;
+  if(fstat(fd, &st) != 0){
+    perror(file_path.c_str());
+    close(fd);
+    return false;
+  }
+
+  size_t num_points = static_cast<size_t>(st.st_size) / OUSTER_BIN_POINT_SIZE;
+  InitOusterCloud(cloud, num_points);
+  if(num_points == 0){
+    close(fd);
+    return true;
+  }
+
+  size_t map_size = num_points * OUSTER_BIN_POINT_SIZE;
+  void *map = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED){
+    perror(file_path.c_str());
+    InitOusterCloud(cloud, 0);
+    return false;
+  }
+  madvise(map, map_size, MADV_SEQUENTIAL);
+
+  WriteOusterPoints(static_cast<const uint8_t *>(map), reinterpret_cast<OusterPoint *>(cloud.data.data()), num_points, scan_period_ns);
+
+  munmap(map, map_size);
+  return true;
+}
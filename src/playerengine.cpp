@@ -0,0 +1,855 @@
+#include "file_player/playerengine.h"
+
+using namespace std;
+
+
+PlayerEngine::PlayerEngine()
+  :ouster_prefetcher_("Ouster"), radarpolar_prefetcher_("Radar")
+{
+  play_rate_ = 1.0;
+  play_flag_ = false;
+  pause_flag_ = false;
+  loop_flag_ = false;
+  stop_skip_flag_ = true;
+
+  radarpolar_active_ = true;
+  imu_active_ = true ;// OFF in v1 (11/13/2019 released), giseop
+
+  ouster_prefetch_depth_ = 8;
+  ouster_prefetch_bytes_ = 256 << 20;
+  ouster_prefetch_threads_ = 2;
+  radarpolar_prefetch_depth_ = 4;
+  radarpolar_prefetch_bytes_ = 64 << 20;
+  radarpolar_prefetch_threads_ = 2;
+  radarpolar_raw_ = true;
+  radarpolar_compressed_ = false;
+  radarray_source_ = false;
+  radarray_active_ = false;
+  ouster_scan_period_ns_ = OUSTER_SCAN_PERIOD_NS;
+  reduction_active_ = false;
+  point_layout_ = POINT_LAYOUT_FULL;
+  point_scale_ = 0.005f;
+  export_threads_ = max(1u, std::thread::hardware_concurrency());
+  export_memory_bytes_ = static_cast<size_t>(1024) << 20;
+  export_split_duration_ = 0;
+  export_split_bytes_ = 0;
+  export_split_overlap_ = 1000000000LL;
+  export_split_writers_ = 2;
+  export_checkpoint_period_ = 60.0;
+  export_resume_ = true;
+  reset_process_stamp_flag_ = false;
+  auto_start_flag_ = true;
+  stamp_show_count_ = 0;
+  imu_data_version_ = 0;
+  prev_clock_stamp_ = 0;
+  stats_late_warn_ns_ = 10000000;
+  lockstep_flag_ = false;
+  lockstep_sensor_ = SENSOR_OUSTER;
+  lockstep_window_ = 1;
+  lockstep_timeout_ = 1.0;
+  lockstep_sent_ = 0;
+  lockstep_acked_ = 0;
+  seek_generation_ = 0;
+  seek_start_ns_ = 0;
+  for(int i = 0 ; i < NUM_SENSORS ; i ++) sensor_threads_[i] = NULL;
+}
+
+
+PlayerEngine::~PlayerEngine()
+{
+  Shutdown();
+}
+
+
+void
+PlayerEngine::Shutdown()
+{
+  stats_timer_.stop();
+  data_stamp_thread_.active_ = false;
+  scheduler_.Wake();
+  if(data_stamp_thread_.thread_.joinable())  data_stamp_thread_.thread_.join();
+  gps_thread_.stop();
+  if(gps_thread_.thread_.joinable()) gps_thread_.thread_.join();
+  imu_thread_.stop();
+  if(imu_thread_.thread_.joinable()) imu_thread_.thread_.join();
+  ouster_thread_.stop(); // giseop
+  if(ouster_thread_.thread_.joinable()) ouster_thread_.thread_.join();
+  ouster_prefetcher_.Stop();
+  radarpolar_thread_.stop(); // giseop
+  if(radarpolar_thread_.thread_.joinable()) radarpolar_thread_.thread_.join();
+  radarpolar_prefetcher_.Stop();
+
+}
+
+
+void 
+PlayerEngine::ros_initialize(ros::NodeHandle &n, const ros::NodeHandle &private_nh)
+{
+  nh_ = n;
+
+  int prefetch_depth, prefetch_mb, prefetch_threads;
+  private_nh.param("ouster_prefetch_depth", prefetch_depth, 8);
+  private_nh.param("ouster_prefetch_mb", prefetch_mb, 256);
+  private_nh.param("ouster_prefetch_threads", prefetch_threads, 2);
+  ouster_prefetch_depth_ = max(0, prefetch_depth);
+  ouster_prefetch_bytes_ = static_cast<size_t>(max(1, prefetch_mb)) << 20;
+  ouster_prefetch_threads_ = max(1, prefetch_threads);
+  double scan_period;
+  private_nh.param("ouster_scan_period", scan_period, 0.1);
+  ouster_scan_period_ns_ = static_cast<uint32_t>(max(0.0, scan_period) * 1e9);
+
+  string point_layout;
+  double point_scale;
+  private_nh.param("point_layout", point_layout, string("full"));
+  private_nh.param("point_scale", point_scale, 0.005);
+  if(!ParsePointLayout(point_layout, point_layout_)) cout << "Unknown point_layout " << point_layout << ", publishing full points" << endl;
+  point_scale_ = static_cast<float>(point_scale);
+
+  double min_range, max_range, voxel_size;
+  vector<double> box;
+  private_nh.param("reduce", reduction_active_, false);
+  private_nh.param("reduce_ring_step", reduction_.ring_step, 1);
+  private_nh.param("reduce_column_step", reduction_.column_step, 1);
+  private_nh.param("reduce_min_range", min_range, 0.0);
+  private_nh.param("reduce_max_range", max_range, 0.0);
+  private_nh.param("reduce_box", box, vector<double>());
+  private_nh.param("reduce_voxel", voxel_size, 0.0);
+  private_nh.param("reduce_threads", reduction_.threads, 2);
+  reduction_.min_range = static_cast<float>(min_range);
+  reduction_.max_range = static_cast<float>(max_range);
+  reduction_.voxel_size = static_cast<float>(voxel_size);
+  reduction_.use_box = (box.size() == 6);
+  if(!box.empty() && !reduction_.use_box) cout << "reduce_box needs [x0, y0, z0, x1, y1, z1], box crop off" << endl;
+  for(size_t i = 0 ; reduction_.use_box && i < 3 ; i ++){
+    reduction_.box_min[i] = static_cast<float>(box[i]);
+    reduction_.box_max[i] = static_cast<float>(box[i+3]);
+  }
+
+  private_nh.param("radar_prefetch_depth", prefetch_depth, 4);
+  private_nh.param("radar_prefetch_mb", prefetch_mb, 64);
+  private_nh.param("radar_prefetch_threads", prefetch_threads, 2);
+  radarpolar_prefetch_depth_ = max(0, prefetch_depth);
+  radarpolar_prefetch_bytes_ = static_cast<size_t>(max(1, prefetch_mb)) << 20;
+  radarpolar_prefetch_threads_ = max(1, prefetch_threads);
+
+  string radar_output;
+  private_nh.param("radar_output", radar_output, string("raw"));
+  radarpolar_raw_ = (radar_output == "raw" || radar_output == "both");
+  radarpolar_compressed_ = (radar_output == "compressed" || radar_output == "both");
+  if(!radarpolar_raw_ && !radarpolar_compressed_){
+    cout << "Unknown radar_output " << radar_output << ", publishing raw" << endl;
+    radarpolar_raw_ = true;
+  }
+  string radar_source;
+  private_nh.param("radar_source", radar_source, string("polar"));
+  radarray_source_ = (radar_source == "ray");
+  //ray images are converted in memory, there is no PNG to pass through
+  if(radarray_source_ && radarpolar_compressed_)
+    cout << "radar_output " << radar_output << " does not apply to radar_source ray : /radar/polar/compressed is only "
+         << "published when there are no radar/ray files and the player falls back to radar/polar" << endl;
+
+  private_nh.param("sequence_cache", sequence_.use_cache_, true);
+
+  int export_threads, export_memory_mb;
+  private_nh.param("export_threads", export_threads, static_cast<int>(std::thread::hardware_concurrency()));
+  private_nh.param("export_memory_mb", export_memory_mb, 1024);
+  export_threads_ = max(1, export_threads);
+  export_memory_bytes_ = static_cast<size_t>(max(1, export_memory_mb)) << 20;
+  double split_duration, split_mb, split_overlap;
+  private_nh.param("export_split_duration", split_duration, 0.0);
+  private_nh.param("export_split_mb", split_mb, 0.0);
+  private_nh.param("export_split_overlap", split_overlap, 1.0);
+  private_nh.param("export_split_writers", export_split_writers_, 2);
+  export_split_duration_ = static_cast<int64_t>(max(0.0, split_duration) * 1e9);
+  export_split_bytes_ = static_cast<uint64_t>(max(0.0, split_mb) * (1 << 20));
+  export_split_overlap_ = static_cast<int64_t>(max(0.0, split_overlap) * 1e9);
+  export_split_writers_ = max(1, export_split_writers_);
+  private_nh.param("export_checkpoint", export_checkpoint_period_, 60.0);
+  export_checkpoint_period_ = max(0.0, export_checkpoint_period_);
+  private_nh.param("export_resume", export_resume_, true);
+
+  string lockstep_sensor, lockstep_ack_topic;
+  int lockstep_window;
+  private_nh.param("lockstep", lockstep_flag_, false);
+  private_nh.param("lockstep_sensor", lockstep_sensor, string("ouster"));
+  private_nh.param("lockstep_ack_topic", lockstep_ack_topic, string("/file_player/ack"));
+  private_nh.param("lockstep_window", lockstep_window, 1);
+  private_nh.param("lockstep_timeout", lockstep_timeout_, 1.0);
+  lockstep_sensor_ = SensorIdFromName(lockstep_sensor);
+  lockstep_window_ = static_cast<uint64_t>(max(1, lockstep_window));
+
+  double stats_period, stats_late_warn_ms;
+  private_nh.param("stats_period", stats_period, 1.0);
+  private_nh.param("stats_late_warn_ms", stats_late_warn_ms, 10.0);
+  stats_late_warn_ns_ = static_cast<int64_t>(stats_late_warn_ms * 1e6);
+
+  start_sub_  = nh_.subscribe<std_msgs::Bool>("/file_player_start", 1, boost::bind(&PlayerEngine::FilePlayerStart, this, _1));
+  stop_sub_   = nh_.subscribe<std_msgs::Bool>("/file_player_stop", 1, boost::bind(&PlayerEngine::FilePlayerStop, this, _1));
+  lockstep_ack_sub_ = nh_.subscribe<topic_tools::ShapeShifter>(lockstep_ack_topic, 100, boost::bind(&PlayerEngine::LockstepAck, this, _1));
+
+  clock_pub_ = nh_.advertise<rosgraph_msgs::Clock>("/clock", 1);
+  gps_pub_ = nh_.advertise<sensor_msgs::NavSatFix>("/gps/fix", 1000);
+  imu_pub_ = nh_.advertise<sensor_msgs::Imu>("/imu/data_raw", 1000);
+  ouster_pub_ = nh_.advertise<sensor_msgs::PointCloud2>("/os1_points", 1000); // giseop
+  if(reduction_active_) ouster_reduced_pub_ = nh_.advertise<sensor_msgs::PointCloud2>("/os1_points_reduced", 1000);
+  if(radarpolar_raw_) radarpolar_pub_ = nh_.advertise<sensor_msgs::Image>("/radar/polar", 10); // giseop
+  if(radarpolar_compressed_) radarpolar_compressed_pub_ = nh_.advertise<sensor_msgs::CompressedImage>("/radar/polar/compressed", 10);
+  if(radarray_source_) radarray_pub_ = nh_.advertise<sensor_msgs::Image>("/radar/oxford", 10);
+
+  stats_pub_ = nh_.advertise<diagnostic_msgs::DiagnosticArray>("/file_player/stats", 10);
+  if(stats_period > 0.0)
+    stats_timer_ = nh_.createTimer(ros::Duration(stats_period), boost::bind(&PlayerEngine::StatsCallback, this, _1));
+}
+
+
+void 
+PlayerEngine::Ready()
+{
+  data_stamp_thread_.active_ = false;
+  scheduler_.Wake();
+  if(data_stamp_thread_.thread_.joinable())  data_stamp_thread_.thread_.join();
+
+  gps_thread_.stop();
+  if(gps_thread_.thread_.joinable()) gps_thread_.thread_.join();
+
+  imu_thread_.stop();
+  if(imu_thread_.thread_.joinable()) imu_thread_.thread_.join();
+
+  ouster_thread_.stop(); // giseop
+  if(ouster_thread_.thread_.joinable()) ouster_thread_.thread_.join();
+  ouster_prefetcher_.Stop();
+
+  radarpolar_thread_.stop(); // giseop
+  if(radarpolar_thread_.thread_.joinable()) radarpolar_thread_.thread_.join();
+  radarpolar_prefetcher_.Stop();
+
+  if(!sequence_.Load(data_folder_path_, imu_active_)) return;
+  initial_data_stamp_ = sequence_.initial_data_stamp_;
+  last_data_stamp_ = sequence_.last_data_stamp_;
+  imu_data_version_ = sequence_.imu_data_version_;
+  play_clock_.Seek(0);
+  reset_process_stamp_flag_ = false;
+  seek_generation_++;  //anything left in the queues belongs to the previous sequence
+  seek_start_ns_ = 0;
+  prev_clock_stamp_ = 0;
+
+  //route each timeline sensor to its publisher thread, NULL drops the event
+  sensor_threads_[SENSOR_IMU] = imu_active_ ? &imu_thread_ : NULL;
+  sensor_threads_[SENSOR_GPS] = &gps_thread_;
+  sensor_threads_[SENSOR_OUSTER] = &ouster_thread_;
+  sensor_threads_[SENSOR_RADAR] = radarpolar_active_ ? &radarpolar_thread_ : NULL;
+  sensor_threads_[SENSOR_UNKNOWN] = NULL;
+
+  ouster_prefetcher_.Start(sequence_.ouster_file_stamps_.size(),
+                           [this](size_t index, sensor_msgs::PointCloud2 &cloud){
+                             return LoadOusterScan(sequence_.OusterPath(sequence_.ouster_file_stamps_[index]), cloud, ouster_scan_period_ns_);
+                           },
+                           [](const sensor_msgs::PointCloud2 &cloud){ return cloud.data.size(); },
+                           ouster_prefetch_depth_, ouster_prefetch_bytes_, ouster_prefetch_threads_);
+  //radar_source ray : Oxford-format images converted from radar/ray/*.csv on the decode threads
+  radarray_active_ = radarpolar_active_ && radarray_source_ && sequence_.UseRadarRay();
+  if(radarpolar_active_ && radarray_source_ && !radarray_active_) cout << "No radar/ray files, publishing radar/polar" << endl;
+  if(radarray_active_)
+    radarpolar_prefetcher_.Start(sequence_.radarray_file_stamps_.size(),
+                                 [this](size_t index, RadarPolarFrame &frame){
+                                   return LoadRadarRayCsv(sequence_.RadarrayPath(sequence_.radarray_file_stamps_[index]), frame.image);
+                                 },
+                                 [](const RadarPolarFrame &frame){ return frame.image.total() * frame.image.elemSize(); },
+                                 radarpolar_prefetch_depth_, radarpolar_prefetch_bytes_, radarpolar_prefetch_threads_);
+  else if(radarpolar_active_)
+    radarpolar_prefetcher_.Start(sequence_.radarpolar_file_stamps_.size(),
+                                 [this](size_t index, RadarPolarFrame &frame){
+                                   //the compressed topic passes the PNG bytes through, only raw needs a decode
+                                   return LoadRadarPolar(sequence_.RadarpolarPath(sequence_.radarpolar_file_stamps_[index]), frame, radarpolar_raw_);
+                                 },
+                                 [](const RadarPolarFrame &frame){ return frame.png.size() + frame.image.total() * frame.image.elemSize(); },
+                                 radarpolar_prefetch_depth_, radarpolar_prefetch_bytes_, radarpolar_prefetch_threads_);
+
+  data_stamp_thread_.active_ = true;
+  gps_thread_.active_ = true;
+  imu_thread_.active_ = true;
+  ouster_thread_.active_ = true;
+  radarpolar_thread_.active_ = true;
+
+  data_stamp_thread_.thread_ = std::thread(&PlayerEngine::DataStampThread,this);
+  gps_thread_.thread_ = std::thread(&PlayerEngine::GpsThread,this);
+  imu_thread_.thread_ = std::thread(&PlayerEngine::ImuThread,this);
+  ouster_thread_.thread_ = std::thread(&PlayerEngine::OusterThread,this);
+  radarpolar_thread_.thread_ = std::thread(&PlayerEngine::RadarpolarThread,this);
+}
+
+
+void 
+PlayerEngine::DataStampThread()
+{
+  const Timeline &timeline = sequence_.data_stamp_;
+  uint32_t seek_generation = seek_generation_;  //of the events dispatched from here
+  scheduler_.ResetStats();
+  auto stop_region_iter = stop_period_.begin();
+
+  for(size_t i = 0 ; i < timeline.size() ; i ++)
+  {
+    auto stamp = timeline[i].stamp;
+    //sleep until the play clock reaches the event (lockstep : until the consumer acked)
+    auto ack_deadline = PlayClock::Clock::time_point::max();
+    while(data_stamp_thread_.active_ == true && reset_process_stamp_flag_ == false)
+    {
+      uint64_t generation = scheduler_.Generation();
+      if(lockstep_flag_ == true && play_flag_ == true && pause_flag_ == false)
+      {
+        if(timeline[i].sensor != lockstep_sensor_ || lockstep_sent_ < lockstep_acked_ + lockstep_window_) break;
+        if(lockstep_timeout_ <= 0.0)
+        {
+          scheduler_.Wait(generation);
+          continue;
+        }
+        auto now = PlayClock::Clock::now();
+        if(ack_deadline == PlayClock::Clock::time_point::max())
+          ack_deadline = now + std::chrono::nanoseconds(static_cast<int64_t>(lockstep_timeout_ * 1e9));
+        if(now >= ack_deadline)
+        {
+          cout << "Lockstep : no ack within " << lockstep_timeout_ << " s, going on" << endl;
+          lockstep_acked_ = lockstep_sent_.load();
+          break;
+        }
+        scheduler_.WaitUntil(generation, ack_deadline);
+        continue;
+      }
+      auto deadline = play_clock_.WallTime(stamp - initial_data_stamp_);
+      if(deadline == PlayClock::Clock::time_point::max())
+      {
+        scheduler_.Wait(generation);  //stopped or paused, until play, resume, seek, rate change or shutdown
+        continue;
+      }
+      if(PlayClock::Clock::now() >= deadline) break;
+      scheduler_.WaitUntil(generation, deadline);
+    }
+
+    if(reset_process_stamp_flag_ == true)
+    {
+      //clear first, a seek landing while relocating sets it again
+      reset_process_stamp_flag_ = false;
+      seek_generation = seek_generation_;
+      auto target_stamp = play_clock_.Now() + initial_data_stamp_;
+      //set index, the loop increment lands on the first event at or after target (wraps to 0 at the start)
+      i = timeline.LowerBound(target_stamp) - 1;
+      //set stop region order
+      auto new_stamp = (i < timeline.size()) ? timeline[i].stamp : initial_data_stamp_;
+      stop_region_iter = stop_period_.upper_bound(new_stamp);
+
+      lockstep_acked_ = lockstep_sent_.load();
+      continue;
+    }
+
+    //check whether stop region or not
+    if(stop_region_iter != stop_period_.end() && stamp == stop_region_iter->first)
+    {
+      if(stop_skip_flag_ == true)
+      {
+        cout << "Skip stop section!!" << endl;
+        i = timeline.Find(stop_region_iter->second) - 1;  //find stop region end
+        play_clock_.Seek(stop_region_iter->second - initial_data_stamp_);
+      }
+      stop_region_iter++;
+      if(stop_skip_flag_ == true)
+      {
+        continue;
+      }
+    }
+
+    if(data_stamp_thread_.active_ == false)
+      break;
+
+    auto due = play_clock_.WallTime(stamp - initial_data_stamp_);
+    if(due != PlayClock::Clock::time_point::max())
+      scheduler_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(PlayClock::Clock::now() - due).count());
+
+    SensorThread *sensor_thread = sensor_threads_[timeline[i].sensor];
+    if(sensor_thread != NULL)
+    {
+      //a full queue means the publisher is behind, wait for it rather than drop the event
+      SensorEvent event;
+      event.stamp = stamp;
+      event.index = timeline[i].index;
+      event.generation = seek_generation;
+      while(sensor_thread->push(event) == false && data_stamp_thread_.active_ == true)
+        std::this_thread::yield();
+      sensor_stats_[timeline[i].sensor].queue_depth_.Record(sensor_thread->size());
+      if(lockstep_flag_ == true && timeline[i].sensor == lockstep_sensor_) lockstep_sent_++;
+    }
+    if(lockstep_flag_ == true) play_clock_.Seek(stamp - initial_data_stamp_);  //the clock follows the events
+    stamp_show_count_++;
+    if(stamp_show_count_ > 100)
+    {
+      stamp_show_count_ = 0;
+      OnStamp(stamp);
+    }
+
+    if(lockstep_flag_ == true || prev_clock_stamp_ == 0 || (stamp - prev_clock_stamp_) > 10000000){
+      rosgraph_msgs::Clock clock;
+
+
+      clock.clock.fromNSec(stamp);
+      clock_pub_.publish(clock);
+      prev_clock_stamp_ = stamp;
+    }
+
+    if(i == timeline.size() - 1)
+    {
+      //without loop stop at the end, the wait above sleeps until the next play
+      if(loop_flag_ == false)
+      {
+        play_flag_ = false;
+        play_clock_.SetRunning(false);
+      }
+      play_clock_.Seek(0);
+      i = -1;
+      stop_region_iter = stop_period_.begin();
+      prev_clock_stamp_ = 0;
+    }
+
+
+  }
+  scheduler_.PrintReport("Data stamp");
+}
+
+
+void PlayerEngine::GpsThread()
+{
+  SensorEvent event;
+  while(1){
+    gps_thread_.wait();
+    if(gps_thread_.active_ == false) return;
+
+    while(gps_thread_.pop(event)){
+      if(event.generation != seek_generation_) continue;  //dispatched before a seek
+      //process
+      if(event.index >= 0){
+        auto start = PlayClock::Clock::now();
+        sensor_msgs::NavSatFixPtr gps_msg = boost::make_shared<sensor_msgs::NavSatFix>();
+        sequence_.gps_data_.ToMsg(event.index, *gps_msg);
+        auto ready = PlayClock::Clock::now();
+        gps_pub_.publish(sensor_msgs::NavSatFixConstPtr(gps_msg));
+        RecordPublish(SENSOR_GPS, event.stamp, start, ready);
+      }
+
+    }
+  }
+}
+
+
+
+
+void 
+PlayerEngine::ImuThread()
+{
+  SensorEvent event;
+  while(1){
+    imu_thread_.wait();
+    if(imu_thread_.active_ == false) return;
+
+    while(imu_thread_.pop(event))
+    {
+      if(event.generation != seek_generation_) continue;  //dispatched before a seek
+      //process
+      auto index = event.index;
+      if(index >= 0)
+      {
+        auto start = PlayClock::Clock::now();
+        sensor_msgs::ImuPtr imu_msg = boost::make_shared<sensor_msgs::Imu>();
+        sequence_.imu_data_.ToMsg(index, *imu_msg);
+        auto ready = PlayClock::Clock::now();
+        imu_pub_.publish(sensor_msgs::ImuConstPtr(imu_msg));
+        RecordPublish(SENSOR_IMU, event.stamp, start, ready);
+
+        // imu_origin_pub_.publish(imu_data_origin_[data]);
+        if(imu_data_version_ == 2)
+        {
+          sensor_msgs::MagneticFieldPtr mag_msg = boost::make_shared<sensor_msgs::MagneticField>();
+          sequence_.imu_data_.ToMsg(index, *mag_msg);
+          magnet_pub_.publish(sensor_msgs::MagneticFieldConstPtr(mag_msg)); // Warning publisher has not been initialized
+        }
+      }
+    }
+  }
+}
+
+
+void 
+PlayerEngine::OusterThread()
+{
+  ReductionScratch reduction_scratch;
+  SensorEvent event;
+  while(1)
+  {
+    ouster_thread_.wait();
+    if(ouster_thread_.active_ == false)
+      return;
+
+    while(ouster_thread_.pop(event))
+    {
+      if(event.generation != seek_generation_) continue;  //dispatched before a seek
+      auto data = event.stamp;
+      auto current_file_index = event.index;
+      if(current_file_index < 0) continue;
+
+      //publish data, read-ahead threads keep the following frames decoded
+      //every message is a fresh shared_ptr handed to publish() as const : subscribers in the
+      //same process (nodelets) get the pointer itself and nothing is serialized or copied
+      auto start = PlayClock::Clock::now();
+      sensor_msgs::PointCloud2Ptr publish_cloud = boost::make_shared<sensor_msgs::PointCloud2>();
+      if(ouster_prefetcher_.Get(current_file_index, *publish_cloud))
+      {
+        publish_cloud->header.stamp.fromNSec(data);
+        publish_cloud->header.frame_id = "ouster";
+        if(point_layout_ != POINT_LAYOUT_FULL)
+        {
+          sensor_msgs::PointCloud2Ptr encoded_cloud = boost::make_shared<sensor_msgs::PointCloud2>();
+          EncodeOusterCloud(*publish_cloud, *encoded_cloud, point_layout_, point_scale_);
+          auto ready = PlayClock::Clock::now();
+          ouster_pub_.publish(sensor_msgs::PointCloud2ConstPtr(encoded_cloud));
+          RecordPublish(SENSOR_OUSTER, data, start, ready);
+        }
+        else
+        {
+          auto ready = PlayClock::Clock::now();
+          ouster_pub_.publish(sensor_msgs::PointCloud2ConstPtr(publish_cloud));
+          RecordPublish(SENSOR_OUSTER, data, start, ready);
+        }
+
+        //reduced copy after the full cloud is out, so only /os1_points_reduced pays for it.
+        //publish_cloud is only read from here on, subscribers may already hold it
+        if(reduction_active_)
+        {
+          auto reduce_start = PlayClock::Clock::now();
+          sensor_msgs::PointCloud2Ptr reduced_cloud = boost::make_shared<sensor_msgs::PointCloud2>();
+          size_t kept = ReduceCloud(*publish_cloud, *reduced_cloud, reduction_, reduction_scratch);
+          reduced_cloud->header = publish_cloud->header;
+          if(point_layout_ != POINT_LAYOUT_FULL)
+          {
+            sensor_msgs::PointCloud2Ptr encoded_cloud = boost::make_shared<sensor_msgs::PointCloud2>();
+            EncodeOusterCloud(*reduced_cloud, *encoded_cloud, point_layout_, point_scale_);
+            ouster_reduced_pub_.publish(sensor_msgs::PointCloud2ConstPtr(encoded_cloud));
+          }
+          else ouster_reduced_pub_.publish(sensor_msgs::PointCloud2ConstPtr(reduced_cloud));
+          reduction_cost_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(PlayClock::Clock::now() - reduce_start).count());
+          reduction_points_.Record(static_cast<int64_t>(kept));
+        }
+
+        //first frame since a seek during playback
+        if(seek_start_ns_ != 0 && event.generation == seek_generation_)
+        {
+          int64_t seek_start = seek_start_ns_.exchange(0);
+          if(seek_start != 0)
+          {
+            int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(PlayClock::Clock::now().time_since_epoch()).count() - seek_start;
+            seek_latency_.Record(latency);
+            cout << "Seek : first LiDAR frame after " << latency / 1e6 << " ms" << endl;
+          }
+        }
+      }
+    }
+  }
+}
+
+
+void 
+PlayerEngine::RadarpolarThread()
+{
+  SensorEvent event;
+  RadarPolarFrame radarpolar_frame;
+  while(1){
+    radarpolar_thread_.wait();
+    if(radarpolar_thread_.active_ == false)
+      return;
+
+    while(radarpolar_thread_.pop(event))
+    {
+      if(event.generation != seek_generation_) continue;  //dispatched before a seek
+      auto data = event.stamp;
+      if(event.index < 0) continue;
+
+      //publish, decode threads keep the following images ready
+      auto start = PlayClock::Clock::now();
+      if(radarpolar_prefetcher_.Get(event.index, radarpolar_frame))
+      {
+        auto ready = PlayClock::Clock::now();
+        if(radarray_active_)
+        {
+          cv_bridge::CvImage radarray_out_msg;
+          radarray_out_msg.header.stamp.fromNSec(data);
+          radarray_out_msg.header.frame_id = "radar_polar";
+          radarray_out_msg.encoding = sensor_msgs::image_encodings::MONO8;
+          radarray_out_msg.image    = radarpolar_frame.image;
+          radarray_pub_.publish(radarray_out_msg.toImageMsg());
+        }
+        else if(radarpolar_raw_)
+        {
+          cv_bridge::CvImage radarpolar_out_msg;
+          radarpolar_out_msg.header.stamp.fromNSec(data);
+          radarpolar_out_msg.header.frame_id = "radar_polar";
+          radarpolar_out_msg.encoding = sensor_msgs::image_encodings::MONO8;
+          radarpolar_out_msg.image    = radarpolar_frame.image;
+          radarpolar_pub_.publish(radarpolar_out_msg.toImageMsg());
+        }
+        if(radarpolar_compressed_ && !radarray_active_)
+        {
+          //file bytes as they are, the buffer moves into the message so nothing is copied or decoded
+          sensor_msgs::CompressedImagePtr compressed_msg = boost::make_shared<sensor_msgs::CompressedImage>();
+          compressed_msg->header.stamp.fromNSec(data);
+          compressed_msg->header.frame_id = "radar_polar";
+          compressed_msg->format = RADAR_POLAR_FORMAT;
+          compressed_msg->data.swap(radarpolar_frame.png);
+          radarpolar_compressed_pub_.publish(sensor_msgs::CompressedImageConstPtr(compressed_msg));
+        }
+        RecordPublish(SENSOR_RADAR, data, start, ready);
+      }
+    }
+  }
+}
+
+
+void 
+PlayerEngine::RecordPublish(int sensor, int64_t stamp, PlayClock::Clock::time_point start, PlayClock::Clock::time_point ready)
+{
+  SensorStats &stats = sensor_stats_[sensor];
+  stats.decode_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(ready - start).count());
+  auto due = play_clock_.WallTime(stamp - initial_data_stamp_);
+  if(due != PlayClock::Clock::time_point::max())
+    stats.lateness_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(PlayClock::Clock::now() - due).count());
+}
+
+
+static void
+AddStatsValue(diagnostic_msgs::DiagnosticStatus &status, const string &key, double value)
+{
+  diagnostic_msgs::KeyValue kv;
+  kv.key = key;
+  kv.value = to_string(value);
+  status.values.push_back(kv);
+}
+
+
+void 
+PlayerEngine::StatsCallback(const ros::TimerEvent& event)
+{
+  double period = (event.current_real - event.last_real).toSec();
+  if(event.last_real.isZero() || period <= 0.0) period = (event.current_expected - event.last_expected).toSec();
+  if(period <= 0.0) period = 1.0;
+
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = ros::Time::now();
+  ostringstream text;
+  text.setf(ios::fixed);
+  text.precision(1);
+  for(int i = 0 ; i < SENSOR_UNKNOWN ; i ++)
+  {
+    HistogramSummary lateness = sensor_stats_[i].lateness_.TakeInterval();
+    HistogramSummary decode = sensor_stats_[i].decode_.TakeInterval();
+    HistogramSummary depth = sensor_stats_[i].queue_depth_.TakeInterval();
+
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = string("file_player/") + kSensorNames[i];
+    status.hardware_id = "file_player";
+    status.level = (lateness.p99 > stats_late_warn_ns_) ? diagnostic_msgs::DiagnosticStatus::WARN : diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = (status.level == diagnostic_msgs::DiagnosticStatus::OK) ? "on time" : "late";
+    AddStatsValue(status, "rate_hz", lateness.count / period);
+    AddStatsValue(status, "lateness_mean_ms", lateness.mean / 1e6);
+    AddStatsValue(status, "lateness_p50_ms", lateness.p50 / 1e6);
+    AddStatsValue(status, "lateness_p99_ms", lateness.p99 / 1e6);
+    AddStatsValue(status, "lateness_max_ms", lateness.max / 1e6);
+    AddStatsValue(status, "decode_mean_ms", decode.mean / 1e6);
+    AddStatsValue(status, "decode_p99_ms", decode.p99 / 1e6);
+    AddStatsValue(status, "decode_max_ms", decode.max / 1e6);
+    AddStatsValue(status, "queue_depth_mean", depth.mean);
+    AddStatsValue(status, "queue_depth_max", depth.max);
+    if(i == SENSOR_OUSTER)
+    {
+      AddStatsValue(status, "read_ahead_hits", ouster_prefetcher_.hits());
+      AddStatsValue(status, "read_ahead_misses", ouster_prefetcher_.misses());
+      HistogramSummary reduction = reduction_cost_.TakeInterval();
+      HistogramSummary kept = reduction_points_.TakeInterval();
+      if(reduction.count > 0)
+      {
+        AddStatsValue(status, "reduce_mean_ms", reduction.mean / 1e6);
+        AddStatsValue(status, "reduce_p99_ms", reduction.p99 / 1e6);
+        AddStatsValue(status, "reduce_max_ms", reduction.max / 1e6);
+        AddStatsValue(status, "reduce_points_mean", kept.mean);
+        text << "reduce p99 " << reduction.p99 / 1e6 << " ms, " << kept.mean << " pts   ";
+      }
+    }
+    if(i == SENSOR_RADAR)
+    {
+      AddStatsValue(status, "read_ahead_hits", radarpolar_prefetcher_.hits());
+      AddStatsValue(status, "read_ahead_misses", radarpolar_prefetcher_.misses());
+    }
+    array.status.push_back(status);
+
+    if(lateness.count == 0) continue;
+    text << kSensorNames[i] << " " << lateness.count / period << " Hz, late p99 " << lateness.p99 / 1e6
+         << " ms, decode p99 " << decode.p99 / 1e6 << " ms, queue max " << depth.max << "   ";
+  }
+  HistogramSummary seek = seek_latency_.TakeInterval();
+  if(seek.count > 0)
+  {
+    diagnostic_msgs::DiagnosticStatus status;
+    status.name = "file_player/seek";
+    status.hardware_id = "file_player";
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.message = "first LiDAR frame after seek";
+    AddStatsValue(status, "seeks", seek.count);
+    AddStatsValue(status, "latency_mean_ms", seek.mean / 1e6);
+    AddStatsValue(status, "latency_max_ms", seek.max / 1e6);
+    array.status.push_back(status);
+    text << "seek " << seek.mean / 1e6 << " ms";
+  }
+  stats_pub_.publish(array);
+  OnStats(text.str());
+}
+
+
+void
+PlayerEngine::OnStart()
+{
+  //same as the Play / End button
+  if(play_flag_ == false)
+  {
+    SetPlayFlag(true);
+    SetPauseFlag(false);
+  }
+  else SetPlayFlag(false);
+}
+
+
+void 
+PlayerEngine::FilePlayerStart(const std_msgs::BoolConstPtr& msg)
+{
+  if(auto_start_flag_ == true){
+    cout << "File player auto start" << endl;
+    usleep(1000000);
+    SetPlayFlag(false);
+    OnStart();
+  }
+}
+
+
+void 
+PlayerEngine::FilePlayerStop(const std_msgs::BoolConstPtr& msg)
+{
+  cout << "File player auto stop" << endl;
+  SetPlayFlag(true);
+
+  OnStart();
+}
+
+
+void 
+PlayerEngine::ResetProcessStamp(int position)
+{
+  if(position >= 0 && position <= 10000){
+    //int64 all the way, float loses whole milliseconds over an hour long sequence
+    int64_t target = (last_data_stamp_ - initial_data_stamp_) * position / 10000;
+    seek_start_ns_ = (play_flag_ == true && pause_flag_ == false) ?
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(PlayClock::Clock::now().time_since_epoch()).count() : 0;
+    SeekTo(target);
+  }
+}
+
+
+void 
+PlayerEngine::SeekTo(int64_t position)
+{
+  //clock first, then the generation that flushes the queues, then wake the dispatcher to relocate
+  play_clock_.Seek(position);
+  seek_generation_++;
+  ouster_prefetcher_.Seek(sequence_.ouster_file_stamps_.LowerBound(initial_data_stamp_ + position));
+  const StampIndex &radar_files = radarray_active_ ? sequence_.radarray_file_stamps_ : sequence_.radarpolar_file_stamps_;
+  radarpolar_prefetcher_.Seek(radar_files.LowerBound(initial_data_stamp_ + position));
+  reset_process_stamp_flag_ = true;
+  scheduler_.Wake();
+}
+
+
+void 
+PlayerEngine::SetPlayFlag(bool flag)
+{
+  play_flag_ = flag;
+  if(flag == false)
+  {
+    //stop rewinds to the start
+    prev_clock_stamp_ = 0;
+    seek_start_ns_ = 0;
+    SeekTo(0);
+  }
+  UpdateClockRunning();
+  scheduler_.Wake();
+}
+
+
+void 
+PlayerEngine::SetPauseFlag(bool flag)
+{
+  pause_flag_ = flag;
+  UpdateClockRunning();
+  scheduler_.Wake();
+}
+
+
+void 
+PlayerEngine::SetPlayRate(double rate)
+{
+  play_rate_ = rate;
+  play_clock_.SetRate(rate);
+  scheduler_.Wake();
+}
+
+
+void 
+PlayerEngine::SetLockstepFlag(bool flag)
+{
+  lockstep_acked_ = lockstep_sent_.load();
+  lockstep_flag_ = flag;
+  UpdateClockRunning();
+  scheduler_.Wake();
+}
+
+
+void 
+PlayerEngine::UpdateClockRunning()
+{
+  //in lockstep the clock does not run on its own, the dispatcher moves it event by event
+  play_clock_.SetRunning(play_flag_ == true && pause_flag_ == false && lockstep_flag_ == false);
+}
+
+
+void 
+PlayerEngine::LockstepAck(const topic_tools::ShapeShifter::ConstPtr& msg)
+{
+  //acks beyond what was sent (late acks after a timeout or a seek, a chatty consumer) are dropped
+  uint64_t acked = lockstep_acked_.load();
+  while(acked < lockstep_sent_.load() && !lockstep_acked_.compare_exchange_weak(acked, acked + 1)){}
+  scheduler_.Wake();
+}
+
+
+void PlayerEngine::SaveRosbag() {
+    ExportOptions options;
+    options.output_path = data_folder_path_ + "/imu_lidar_output.bag";
+    options.threads = export_threads_;
+    options.memory_bytes = export_memory_bytes_;
+    options.ouster_scan_period_ns = ouster_scan_period_ns_;
+    options.ouster_reduced = reduction_active_;
+    options.reduction = reduction_;
+    options.reduction.threads = 1;  // the export decode threads already work on separate scans
+    options.point_layout = point_layout_;
+    options.point_scale = point_scale_;
+    options.split_duration = export_split_duration_;
+    options.split_bytes = export_split_bytes_;
+    options.split_overlap = export_split_overlap_;
+    options.split_writers = export_split_writers_;
+    options.checkpoint_period = export_checkpoint_period_;
+    options.resume = export_resume_;
+    ExportBag(sequence_, options);
+}
+
+// End of file
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "file_player/pointfields.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define POINTFIELDS_X86
+#endif
+
+static_assert(sizeof(OusterPoint) == 24 && offsetof(OusterPoint, t) == 16 && offsetof(OusterPoint, ring) == 20,
+              "the vector kernels store t and ring as the last 8 bytes of a 24 byte point");
+
+// time of firing column c, exact integer math so every path agrees
+static inline uint32_t
+ColumnTime(uint64_t column, uint64_t columns, uint32_t scan_period_ns)
+{
+  return columns ? static_cast<uint32_t>(column * scan_period_ns / columns) : 0;
+}
+
+
+void
+WriteOusterPointsScalar(const uint8_t *bin, OusterPoint *points, size_t num_points, uint32_t scan_period_ns)
+{
+  const size_t columns = num_points / OUSTER_CHANNELS;
+  for(size_t k = 0 ; k < num_points ; k++){
+    memcpy(&points[k].x, bin + k*OUSTER_BIN_POINT_SIZE, OUSTER_BIN_POINT_SIZE);
+    points[k].t = ColumnTime(k / OUSTER_CHANNELS, columns, scan_period_ns);
+    points[k].ring = static_cast<int32_t>(k % OUSTER_CHANNELS) + 1;
+  }
+}
+
+
+#ifdef POINTFIELDS_X86
+
+// Two points per step : 32 source bytes become three 16 byte stores
+//   [x0 y0 z0 i0] [t r0 x1 y1] [z1 i1 t r1]
+static void
+WriteColumnsSse2(const uint8_t *bin, OusterPoint *points, size_t columns, uint32_t scan_period_ns)
+{
+  const __m128i ring_step = _mm_set_epi32(2, 0, 2, 0);
+  for(size_t c = 0 ; c < columns ; c++){
+    const int32_t t = static_cast<int32_t>(ColumnTime(c, columns, scan_period_ns));
+    __m128i tr = _mm_set_epi32(2, t, 1, t);  // [t ring_k t ring_k+1]
+    const __m128i *src = reinterpret_cast<const __m128i *>(bin + c*OUSTER_CHANNELS*OUSTER_BIN_POINT_SIZE);
+    __m128i *dst = reinterpret_cast<__m128i *>(points + c*OUSTER_CHANNELS);
+    for(int k = 0 ; k < OUSTER_CHANNELS ; k += 2){
+      __m128i p0 = _mm_loadu_si128(src++);
+      __m128i p1 = _mm_loadu_si128(src++);
+      _mm_storeu_si128(dst++, p0);
+      _mm_storeu_si128(dst++, _mm_unpacklo_epi64(tr, p1));
+      _mm_storeu_si128(dst++, _mm_unpackhi_epi64(p1, tr));
+      tr = _mm_add_epi32(tr, ring_step);
+    }
+  }
+}
+
+
+// Four points per step : 64 source bytes become three 32 byte stores, the 16 byte pieces of
+// the SSE2 kernel rearranged across lanes
+__attribute__((target("avx2")))
+static void
+WriteColumnsAvx2(const uint8_t *bin, OusterPoint *points, size_t columns, uint32_t scan_period_ns)
+{
+  const __m256i ring_step = _mm256_set_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+  for(size_t c = 0 ; c < columns ; c++){
+    const int32_t t = static_cast<int32_t>(ColumnTime(c, columns, scan_period_ns));
+    __m256i tr = _mm256_set_epi32(4, t, 3, t, 2, t, 1, t);  // [t r0 t r1 | t r2 t r3]
+    const __m256i *src = reinterpret_cast<const __m256i *>(bin + c*OUSTER_CHANNELS*OUSTER_BIN_POINT_SIZE);
+    __m256i *dst = reinterpret_cast<__m256i *>(points + c*OUSTER_CHANNELS);
+    for(int k = 0 ; k < OUSTER_CHANNELS ; k += 4){
+      __m256i a = _mm256_loadu_si256(src++);                 // [p0 | p1]
+      __m256i b = _mm256_loadu_si256(src++);                 // [p2 | p3]
+      __m256i even = _mm256_permute2x128_si256(a, b, 0x20);  // [p0 | p2]
+      __m256i odd = _mm256_permute2x128_si256(a, b, 0x31);   // [p1 | p3]
+      __m256i lo = _mm256_unpacklo_epi64(tr, odd);           // [t r0 x1 y1 | t r2 x3 y3]
+      __m256i hi = _mm256_unpackhi_epi64(odd, tr);           // [z1 i1 t r1 | z3 i3 t r3]
+      _mm256_storeu_si256(dst++, _mm256_permute2x128_si256(even, lo, 0x20));
+      _mm256_storeu_si256(dst++, _mm256_permute2x128_si256(hi, even, 0x30));
+      _mm256_storeu_si256(dst++, _mm256_permute2x128_si256(lo, hi, 0x31));
+      tr = _mm256_add_epi32(tr, ring_step);
+    }
+  }
+}
+
+#endif // POINTFIELDS_X86
+
+
+bool
+PointFieldsKernelSupported(PointFieldsKernel kernel)
+{
+  switch(kernel){
+    case POINT_FIELDS_SCALAR: return true;
+#ifdef POINTFIELDS_X86
+    case POINT_FIELDS_SSE2: return true;
+    case POINT_FIELDS_AVX2: return __builtin_cpu_supports("avx2");
+#endif
+    default: return false;
+  }
+}
+
+
+PointFieldsKernel
+BestPointFieldsKernel()
+{
+  static const PointFieldsKernel best = PointFieldsKernelSupported(POINT_FIELDS_AVX2) ? POINT_FIELDS_AVX2
+                                        : PointFieldsKernelSupported(POINT_FIELDS_SSE2) ? POINT_FIELDS_SSE2
+                                        : POINT_FIELDS_SCALAR;
+  return best;
+}
+
+
+void
+WriteOusterPointsWith(PointFieldsKernel kernel, const uint8_t *bin, OusterPoint *points, size_t num_points,
+                      uint32_t scan_period_ns)
+{
+#ifdef POINTFIELDS_X86
+  if(kernel == POINT_FIELDS_SSE2 || kernel == POINT_FIELDS_AVX2){
+    const size_t columns = num_points / OUSTER_CHANNELS;
+    if(kernel == POINT_FIELDS_AVX2) WriteColumnsAvx2(bin, points, columns, scan_period_ns);
+    else WriteColumnsSse2(bin, points, columns, scan_period_ns);
+
+    //trailing partial column
+    const size_t done = columns * OUSTER_CHANNELS;
+    for(size_t k = done ; k < num_points ; k++){
+      memcpy(&points[k].x, bin + k*OUSTER_BIN_POINT_SIZE, OUSTER_BIN_POINT_SIZE);
+      points[k].t = ColumnTime(columns, columns, scan_period_ns);
+      points[k].ring = static_cast<int32_t>(k % OUSTER_CHANNELS) + 1;
+    }
+    return;
+  }
+#endif
+  WriteOusterPointsScalar(bin, points, num_points, scan_period_ns);
+}
+
+
+void
+WriteOusterPoints(const uint8_t *bin, OusterPoint *points, size_t num_points, uint32_t scan_period_ns)
+{
+  WriteOusterPointsWith(BestPointFieldsKernel(), bin, points, num_points, scan_period_ns);
+}
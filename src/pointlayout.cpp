@@ -0,0 +1,108 @@
+#include "file_player/pointlayout.h"
+
+using namespace std;
+
+namespace {
+
+// names, offsets and datatypes of the fields of cloud are the ones AddFields writes for Layout
+template <typename Layout>
+bool
+HasFields(const sensor_msgs::PointCloud2 &cloud, float scale)
+{
+  sensor_msgs::PointCloud2 expected;
+  Layout::AddFields(expected, scale);
+  if(cloud.point_step != Layout::STEP || cloud.fields.size() != expected.fields.size()) return false;
+  for(size_t i = 0 ; i < expected.fields.size() ; i ++){
+    const sensor_msgs::PointField &a = cloud.fields[i], &b = expected.fields[i];
+    if(a.name != b.name || a.offset != b.offset || a.datatype != b.datatype || a.count != b.count) return false;
+  }
+  return true;
+}
+
+} // namespace
+
+bool
+ParsePointLayout(const string &name, PointLayout &layout)
+{
+  if(name == "full") layout = POINT_LAYOUT_FULL;
+  else if(name == "xyzi") layout = POINT_LAYOUT_XYZI;
+  else if(name == "xyzirt") layout = POINT_LAYOUT_XYZIRT;
+  else if(name == "xyz16") layout = POINT_LAYOUT_XYZ16;
+  else return false;
+  return true;
+}
+
+
+uint32_t
+PointLayoutStep(PointLayout layout)
+{
+  switch(layout){
+    case POINT_LAYOUT_XYZI:   return point_layout::Xyzi::STEP;
+    case POINT_LAYOUT_XYZIRT: return point_layout::Xyzirt::STEP;
+    case POINT_LAYOUT_XYZ16:  return point_layout::Xyz16::STEP;
+    default:                  return sizeof(OusterPoint);
+  }
+}
+
+
+void
+EncodeOusterCloud(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out, PointLayout layout, float scale)
+{
+  switch(layout){
+    case POINT_LAYOUT_XYZI:   point_layout::Encode<point_layout::Xyzi>(in, out, scale); break;
+    case POINT_LAYOUT_XYZIRT: point_layout::Encode<point_layout::Xyzirt>(in, out, scale); break;
+    case POINT_LAYOUT_XYZ16:
+      point_layout::Encode<point_layout::Xyz16>(in, out, point_layout::Xyz16::PrintedScale(scale));
+      break;
+    default:
+      out = in;
+      break;
+  }
+}
+
+
+bool
+PointLayoutOf(const sensor_msgs::PointCloud2 &cloud, PointLayout &layout, float &scale)
+{
+  scale = 0.0f;
+  if(cloud.point_step == sizeof(OusterPoint)){
+    sensor_msgs::PointCloud2 full;
+    InitOusterCloud(full, 0);
+    if(cloud.fields.size() != full.fields.size()) return false;
+    for(size_t i = 0 ; i < full.fields.size() ; i ++)
+      if(cloud.fields[i].name != full.fields[i].name || cloud.fields[i].offset != full.fields[i].offset) return false;
+    layout = POINT_LAYOUT_FULL;
+    return true;
+  }
+  if(HasFields<point_layout::Xyzi>(cloud, 0.0f)) layout = POINT_LAYOUT_XYZI;
+  else if(HasFields<point_layout::Xyzirt>(cloud, 0.0f)) layout = POINT_LAYOUT_XYZIRT;
+  else{
+    // the scale field is the last one (see pointlayout.h)
+    const size_t prefix = strlen(POINT_LAYOUT_SCALE_FIELD);
+    if(cloud.fields.empty() || cloud.fields.back().name.compare(0, prefix, POINT_LAYOUT_SCALE_FIELD) != 0) return false;
+    char *end = NULL;
+    const char *value = cloud.fields.back().name.c_str() + prefix;
+    scale = strtof(value, &end);
+    if(end == value || *end != '\0' || !(scale > 0.0f) || !HasFields<point_layout::Xyz16>(cloud, scale)) return false;
+    layout = POINT_LAYOUT_XYZ16;
+  }
+  return true;
+}
+
+
+bool
+DecodeOusterCloud(const sensor_msgs::PointCloud2 &in, sensor_msgs::PointCloud2 &out)
+{
+  PointLayout layout;
+  float scale;
+  if(!PointLayoutOf(in, layout, scale)) return false;
+  switch(layout){
+    case POINT_LAYOUT_XYZI:   point_layout::Decode<point_layout::Xyzi>(in, out, scale); break;
+    case POINT_LAYOUT_XYZIRT: point_layout::Decode<point_layout::Xyzirt>(in, out, scale); break;
+    case POINT_LAYOUT_XYZ16:  point_layout::Decode<point_layout::Xyz16>(in, out, scale); break;
+    default:
+      out = in;
+      break;
+  }
+  return true;
+}
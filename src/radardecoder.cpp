@@ -0,0 +1,43 @@
+#include "file_player/radardecoder.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <opencv2/highgui/highgui.hpp>
+
+using namespace std;
+
+bool
+ReadFileBytes(const string &file_path, vector<uint8_t> &bytes)
+{
+  int fd = open(file_path.c_str(), O_RDONLY);
+  if(fd < 0) return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0){
+    close(fd);
+    return false;
+  }
+  bytes.resize(static_cast<size_t>(st.st_size));
+  size_t done = 0;
+  while(done < bytes.size()){
+    ssize_t n = read(fd, bytes.data() + done, bytes.size() - done);
+    if(n <= 0) break;
+    done += static_cast<size_t>(n);
+  }
+  close(fd);
+  bytes.resize(done);
+  return !bytes.empty();
+}
+
+
+bool
+LoadRadarPolar(const string &file_path, RadarPolarFrame &frame, bool decode)
+{
+  if(!ReadFileBytes(file_path, frame.png)) return false;
+  if(!decode) return true;
+
+  cv::Mat encoded(1, static_cast<int>(frame.png.size()), CV_8UC1, frame.png.data());
+  cv::imdecode(encoded, cv::IMREAD_GRAYSCALE, &frame.image);
+  return !frame.image.empty();
+}
@@ -0,0 +1,130 @@
+#include "file_player/radarray.h"
+#include "file_player/csvparser.h"
+
+#include <string.h>
+#include <algorithm>
+
+using namespace std;
+
+static inline const char *
+LineEnd(const char *p, const char *end)
+{
+  const char *nl = static_cast<const char *>(memchr(p, '\n', end - p));
+  return nl ? nl : end;
+}
+
+
+// true for lines holding nothing but blanks (trailing lines of some exports)
+static bool
+IsBlankLine(const char *p, const char *end)
+{
+  for( ; p < end ; p ++)
+    if(*p != ' ' && *p != '\t' && *p != '\r') return false;
+  return true;
+}
+
+
+static inline uint8_t
+ToIntensity(double value)
+{
+  //same as imwrite(img/255.0) : clamp to 0..255 and round
+  if(!(value > 0.0)) return 0;
+  if(value >= 255.0) return 255;
+  return static_cast<uint8_t>(value + 0.5);
+}
+
+
+// One intensity field at p (just after its comma). The bins are plain small integers, those
+// are read inline; anything else (decimals, exponents, signs) goes through ParseDouble.
+// Returns the position after the field, NULL for an empty field.
+static inline const char *
+ParseIntensity(const char *p, const char *end, uint8_t &intensity)
+{
+  const char *q = p;
+  unsigned v = 0;
+  while(q < end && static_cast<unsigned>(*q - '0') < 10 && v < 1000){
+    v = v*10 + static_cast<unsigned>(*q - '0');
+    q++;
+  }
+  if(q > p && (q == end || *q == ',' || *q == '\r' || *q == '\n')){
+    intensity = static_cast<uint8_t>(min(v, 255u));
+    return q;
+  }
+  double value;
+  q = ParseDouble(p, end, value);
+  if(q != NULL) intensity = ToIntensity(value);
+  return q;
+}
+
+
+bool
+LoadRadarRayCsv(const string &file_path, cv::Mat &image)
+{
+  MappedFile file;
+  if(!file.Open(file_path)) return false;
+  const char *begin = file.data();
+  const char *end = begin + file.size();
+
+  //first pass : number of azimuth lines and the widest one, so the image is allocated once
+  int rows = 0;
+  size_t max_fields = 0;
+  for(const char *p = begin ; p < end ; ){
+    const char *line_end = LineEnd(p, end);
+    if(!IsBlankLine(p, line_end)){
+      rows++;
+      max_fields = max(max_fields, static_cast<size_t>(count(p, line_end, ',')) + 1);
+    }
+    p = line_end + 1;
+  }
+  if(rows == 0 || max_fields < 4) return false;
+
+  const int bins = static_cast<int>(max_fields - 4);
+  image.create(rows, RADAR_OXFORD_META_COLUMNS + bins, CV_8UC1);
+
+  int row = 0;
+  for(const char *p = begin ; p < end && row < rows ; ){
+    const char *line_end = LineEnd(p, end);
+    if(IsBlankLine(p, line_end)){
+      p = line_end + 1;
+      continue;
+    }
+
+    int64_t stamp;
+    double angle, azimuth, counter;
+    const char *q = ParseInt64(p, line_end, stamp);
+    if(q == NULL || q >= line_end || *q != ',' || (q = ParseDouble(q + 1, line_end, angle)) == NULL) break;
+    if(q >= line_end || *q != ',' || (q = ParseDouble(q + 1, line_end, azimuth)) == NULL) break;
+    if(q >= line_end || *q != ',' || (q = ParseDouble(q + 1, line_end, counter)) == NULL) break;
+
+    uint8_t *out = image.ptr<uint8_t>(row);
+    uint64_t stamp_bits = static_cast<uint64_t>(stamp);
+    for(int b = 0 ; b < 8 ; b ++) out[b] = static_cast<uint8_t>(stamp_bits >> (8*b));
+    //uint16() in the MATLAB script : rounded and saturated
+    uint16_t encoder = static_cast<uint16_t>(min(max(azimuth + 0.5, 0.0), 65535.0));
+    out[8] = static_cast<uint8_t>(encoder);
+    out[9] = static_cast<uint8_t>(encoder >> 8);
+    out[10] = 255;
+
+    uint8_t *intensity = out + RADAR_OXFORD_META_COLUMNS;
+    int bin = 0;
+    while(bin < bins && q < line_end && *q == ','){
+      const char *next = ParseIntensity(q + 1, line_end, intensity[bin]);
+      if(next == NULL){
+        //empty field, read as NaN -> 0 by the script
+        intensity[bin++] = 0;
+        q++;
+        continue;
+      }
+      bin++;
+      q = next;
+    }
+    if(bin < bins) memset(intensity + bin, 0, bins - bin);
+
+    row++;
+    p = line_end + 1;
+  }
+
+  if(row == 0) return false;
+  if(row < rows) image = image.rowRange(0, row);
+  return true;
+}
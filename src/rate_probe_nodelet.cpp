@@ -0,0 +1,140 @@
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#include <ros/ros.h>
+#include <sensor_msgs/Imu.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include <mutex>
+#include <string>
+#include <limits>
+#include <sstream>
+#include <iomanip>
+
+#include "file_player/latencystats.h"
+
+namespace file_player
+{
+
+// Receiving end of the node / nodelet throughput comparison. Subscribes to the LiDAR,
+// radar and IMU topics of the player and reports, every ~report_period s, the received
+// rate and bandwidth and the delivery delay of each topic. Loaded into the player's
+// manager it gets the published pointers (intra-process), in a manager of its own every
+// message goes through TCPROS and is serialized and deserialized on the way.
+//
+// The delay is measured against the playback schedule : a message with stamp s is due
+// (s - s0) / ~rate after the first message s0 of its topic arrived, and the delay is its
+// arrival time minus that, minus the smallest such difference seen so far. It holds the
+// transport and queueing cost on top of the fastest delivery, not the absolute latency.
+class RateProbeNodelet : public nodelet::Nodelet
+{
+
+public:
+  RateProbeNodelet() : rate_(1.0){}
+
+private:
+  enum { TOPIC_OUSTER, TOPIC_RADAR, TOPIC_IMU, NUM_TOPICS };
+
+  struct TopicStats{
+    TopicStats() : first_stamp(-1), first_wall(0), min_offset(std::numeric_limits<int64_t>::max()), bytes(0){}
+
+    std::string name;
+    int64_t first_stamp;   // data stamp and arrival [ns] of the first message
+    int64_t first_wall;
+    int64_t min_offset;    // smallest arrival - due so far
+    uint64_t bytes;        // since the last report
+    LatencyHistogram delay;
+  };
+
+  void onInit()
+  {
+    ros::NodeHandle &nh = getNodeHandle();
+    const ros::NodeHandle &private_nh = getPrivateNodeHandle();
+
+    std::string ouster_topic, radar_topic, imu_topic;
+    double report_period;
+    private_nh.param("rate", rate_, 1.0);
+    private_nh.param("report_period", report_period, 5.0);
+    private_nh.param("ouster_topic", ouster_topic, std::string("/os1_points"));
+    private_nh.param("radar_topic", radar_topic, std::string("/radar/polar"));
+    private_nh.param("imu_topic", imu_topic, std::string("/imu/data_raw"));
+    if(rate_ <= 0.0) rate_ = 1.0;
+    topics_[TOPIC_OUSTER].name = ouster_topic;
+    topics_[TOPIC_RADAR].name = radar_topic;
+    topics_[TOPIC_IMU].name = imu_topic;
+
+    // ConstPtr callbacks : intra-process subscribers get the publisher's message itself
+    ouster_sub_ = nh.subscribe(ouster_topic, 1000, &RateProbeNodelet::OusterCallback, this);
+    radar_sub_ = nh.subscribe(radar_topic, 100, &RateProbeNodelet::RadarCallback, this);
+    imu_sub_ = nh.subscribe(imu_topic, 10000, &RateProbeNodelet::ImuCallback, this);
+    last_report_ = ros::WallTime::now();
+    report_timer_ = nh.createWallTimer(ros::WallDuration(report_period), &RateProbeNodelet::Report, this);
+    NODELET_INFO_STREAM("rate probe : " << ouster_topic << ", " << radar_topic << ", " << imu_topic
+                        << " at x" << rate_ << ", reporting every " << report_period << " s");
+  }
+
+  void OusterCallback(const sensor_msgs::PointCloud2::ConstPtr &msg)
+  {
+    Receive(TOPIC_OUSTER, msg->header.stamp, msg->data.size());
+  }
+
+  void RadarCallback(const sensor_msgs::Image::ConstPtr &msg)
+  {
+    Receive(TOPIC_RADAR, msg->header.stamp, msg->data.size());
+  }
+
+  void ImuCallback(const sensor_msgs::Imu::ConstPtr &msg)
+  {
+    Receive(TOPIC_IMU, msg->header.stamp, sizeof(sensor_msgs::Imu));
+  }
+
+  void Receive(int topic, const ros::Time &stamp, size_t bytes)
+  {
+    const int64_t wall = static_cast<int64_t>(ros::WallTime::now().toNSec());
+    std::lock_guard<std::mutex> lg(mutex_);
+    TopicStats &stats = topics_[topic];
+    if(stats.first_stamp < 0){
+      stats.first_stamp = static_cast<int64_t>(stamp.toNSec());
+      stats.first_wall = wall;
+    }
+    const int64_t due = stats.first_wall + static_cast<int64_t>((static_cast<int64_t>(stamp.toNSec()) - stats.first_stamp) / rate_);
+    const int64_t offset = wall - due;
+    if(offset < stats.min_offset) stats.min_offset = offset;
+    stats.delay.Record(offset - stats.min_offset);
+    stats.bytes += bytes;
+  }
+
+  void Report(const ros::WallTimerEvent &)
+  {
+    const ros::WallTime now = ros::WallTime::now();
+    const double period = (now - last_report_).toSec();
+    last_report_ = now;
+    if(period <= 0.0) return;
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(2) << "rate probe :";
+    std::lock_guard<std::mutex> lg(mutex_);
+    for(int t = 0 ; t < NUM_TOPICS ; t ++){
+      TopicStats &stats = topics_[t];
+      HistogramSummary delay = stats.delay.TakeInterval();
+      text << "\n  " << stats.name << " : " << delay.count / period << " Hz, "
+           << stats.bytes / period / (1 << 20) << " MB/s, delay mean " << delay.mean / 1e6
+           << " ms, p99 " << delay.p99 / 1e6 << " ms, max " << delay.max / 1e6 << " ms";
+      stats.bytes = 0;
+    }
+    NODELET_INFO_STREAM(text.str());
+  }
+
+  double rate_;
+  std::mutex mutex_;
+  TopicStats topics_[NUM_TOPICS];
+  ros::Subscriber ouster_sub_;
+  ros::Subscriber radar_sub_;
+  ros::Subscriber imu_sub_;
+  ros::WallTimer report_timer_;
+  ros::WallTime last_report_;
+};
+
+} // namespace file_player
+
+PLUGINLIB_EXPORT_CLASS(file_player::RateProbeNodelet, nodelet::Nodelet)
@@ -0,0 +1,405 @@
+#include "file_player/sequence.h"
+#include "file_player/csvparser.h"
+#include "file_player/sequencecache.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+
+using namespace std;
+
+MulranSequence::MulranSequence()
+{
+  initial_data_stamp_ = 0;
+  last_data_stamp_ = 0;
+  imu_data_version_ = 0;
+  use_cache_ = true;
+}
+
+
+bool
+MulranSequence::Load(const string &data_folder_path, bool load_imu, int num_threads)
+{
+  data_folder_path_ = data_folder_path;
+  imu_data_version_ = 0;  // set again below only when the new sequence has IMU rows
+
+  //check path is right or not
+  ifstream f((data_folder_path_+"/sensor_data/data_stamp.csv").c_str());
+  if(!f.good()){
+    cout << "Please check the file path. The input path is wrong (data_stamp.csv not exist)" << endl;
+    return false;
+  }
+  f.close();
+
+
+
+  //Take the tables from the binary cache when it is still valid, else parse the CSV files
+  //concurrently (each one is itself split over its share of num_threads) and list the directories
+  auto start_time = chrono::steady_clock::now();
+  SequenceTables tables;
+  bool gps_ok = true, imu_ok = true;
+  bool from_cache = use_cache_ && LoadSequenceCache(data_folder_path_, load_imu, tables);
+  if(!from_cache)
+  {
+    SequenceSources sources;
+    GetSequenceSources(data_folder_path_, sources);
+    vector<string> csv_paths;
+    csv_paths.push_back(data_folder_path_+"/sensor_data/data_stamp.csv");
+    csv_paths.push_back(data_folder_path_+"/sensor_data/gps.csv");
+    if(load_imu) csv_paths.push_back(data_folder_path_+"/sensor_data/xsens_imu.csv");
+    vector<int> csv_threads = ShareCsvThreads(csv_paths, num_threads);
+    thread gps_parser([&]{ gps_ok = ParseGpsCsv(csv_paths[1], tables.gps, csv_threads[1]); });
+    thread imu_parser([&]{ imu_ok = load_imu && ParseImuCsv(csv_paths[2], tables.imu, csv_threads[2]); });
+    ParseDataStampCsv(csv_paths[0], tables.stamps, csv_threads[0]);
+    GetDirList(data_folder_path_ + "/sensor_data/Ouster", ouster_file_stamps_);
+    GetDirList(data_folder_path_ + "/sensor_data/radar/polar", radarpolar_file_stamps_);
+    gps_parser.join();
+    imu_parser.join();
+    tables.has_imu = imu_ok;
+    tables.ouster_stamps = ouster_file_stamps_.stamps_;
+    tables.radarpolar_stamps = radarpolar_file_stamps_.stamps_;
+    if(use_cache_ && !tables.stamps.empty() && !SaveSequenceCache(data_folder_path_, sources, tables))
+      cout << "Could not write " << data_folder_path_ << "/sensor_data/" << SEQUENCE_CACHE_NAME << endl;
+  }
+  else
+  {
+    ouster_file_stamps_.stamps_.swap(tables.ouster_stamps);
+    ouster_file_stamps_.Build();
+    radarpolar_file_stamps_.stamps_.swap(tables.radarpolar_stamps);
+    radarpolar_file_stamps_.Build();
+  }
+  const vector<StampRow> &stamp_rows = tables.stamps;
+  const vector<GpsRow> &gps_rows = tables.gps;
+  const vector<ImuRow> &imu_rows = tables.imu;
+
+  //Build the event timeline and the columnar sensor tables
+  data_stamp_.clear();
+  data_stamp_.events_.reserve(stamp_rows.size());
+  for(const auto &row : stamp_rows)
+    data_stamp_.Add(row.stamp, SensorIdFromName(row.name));
+  data_stamp_.Sort();
+  cout << "Stamp data are loaded" << endl;
+  if(data_stamp_.empty()){
+    cout << "data_stamp.csv has no entries" << endl;
+    return false;
+  }
+
+  initial_data_stamp_ = data_stamp_.front().stamp - 1;
+  last_data_stamp_ = data_stamp_.back().stamp - 1;
+
+  gps_data_.Build(gps_rows);
+  if(gps_ok) cout << "Gps data are loaded" << endl;
+  else cout << "Can not read gps.csv" << endl;
+
+  imu_data_.clear();
+  if(load_imu)
+  {
+    imu_data_.Build(imu_rows);
+    if(!imu_rows.empty()) imu_data_version_ = imu_data_.has_motion_ ? 2 : 1;
+    if(imu_ok) cout << "IMU data are loaded" << endl;
+    else cout << "Can not read xsens_imu.csv" << endl;
+  } // read IMU
+
+  //resolve every event to its row once, so playback does no per-event lookups
+  for(auto &event : data_stamp_.events_){
+    switch(event.sensor){
+      case SENSOR_IMU:    event.index = static_cast<int32_t>(imu_data_.Find(event.stamp)); break;
+      case SENSOR_GPS:    event.index = static_cast<int32_t>(gps_data_.Find(event.stamp)); break;
+      case SENSOR_OUSTER: event.index = static_cast<int32_t>(ouster_file_stamps_.Find(event.stamp)); break;
+      case SENSOR_RADAR:  event.index = static_cast<int32_t>(radarpolar_file_stamps_.Find(event.stamp)); break;
+      default: break;
+    }
+  }
+
+  cout << "Sensor tables loaded " << (from_cache ? "from cache" : "from CSV") << " in "
+       << chrono::duration<double>(chrono::steady_clock::now() - start_time).count() << " s" << endl;
+  PrintMemoryReport();
+  return true;
+}
+
+
+void
+MulranSequence::PrintMemoryReport() const
+{
+  // a std::map node is ~32 bytes of links and colour on top of its key/value pair
+  const size_t node = 32 + sizeof(int64_t);
+  size_t imu_bytes = imu_data_.MemoryBytes();
+  size_t gps_bytes = gps_data_.MemoryBytes();
+  size_t map_bytes = data_stamp_.size() * (node + sizeof(std::string))
+                     + gps_data_.size() * (node + sizeof(sensor_msgs::NavSatFix))
+                     + imu_data_.size() * (node + sizeof(sensor_msgs::Imu))
+                     + (imu_data_.has_motion_ ? imu_data_.size() * (node + sizeof(sensor_msgs::MagneticField)) : 0);
+  cout << "Sensor table memory : events " << data_stamp_.size() << " " << data_stamp_.events_.capacity()*sizeof(TimelineEvent) / 1024.0 / 1024.0 << " MB, "
+       << "IMU " << imu_data_.size() << " samples " << imu_bytes / 1024.0 / 1024.0 << " MB, "
+       << "GPS " << gps_data_.size() << " fixes " << gps_bytes / 1024.0 / 1024.0 << " MB "
+       << "(message maps : " << map_bytes / 1024.0 / 1024.0 << " MB)" << endl;
+}
+
+
+string
+MulranSequence::OusterPath(int64_t stamp) const
+{
+  return data_folder_path_ + "/sensor_data/Ouster/" + to_string(stamp) + ".bin";
+}
+
+
+string
+MulranSequence::RadarpolarPath(int64_t stamp) const
+{
+  return data_folder_path_ + "/sensor_data/radar/polar/" + to_string(stamp) + ".png";
+}
+
+
+string
+MulranSequence::RadarrayPath(int64_t stamp) const
+{
+  return data_folder_path_ + "/sensor_data/radar/ray/" + to_string(stamp) + ".csv";
+}
+
+
+bool
+MulranSequence::UseRadarRay()
+{
+  GetDirList(data_folder_path_ + "/sensor_data/radar/ray", radarray_file_stamps_);
+  // without ray files the events keep their radar/polar rows, which the player falls back to
+  if(radarray_file_stamps_.empty()) return false;
+  for(auto &event : data_stamp_.events_)
+    if(event.sensor == SENSOR_RADAR) event.index = static_cast<int32_t>(radarray_file_stamps_.Find(event.stamp));
+  return true;
+}
+
+
+// Indices of rows in stamp order, keeping only the last row of equal stamps (as map[stamp] = row did)
+template <typename Row>
+static vector<size_t>
+SortedRowOrder(const vector<Row> &rows)
+{
+  vector<size_t> order(rows.size());
+  for(size_t i = 0 ; i < rows.size() ; i ++) order[i] = i;
+  stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return rows[a].stamp < rows[b].stamp; });
+  vector<size_t> unique_order;
+  unique_order.reserve(order.size());
+  for(size_t i = 0 ; i < order.size() ; i ++){
+    if(i + 1 < order.size() && rows[order[i+1]].stamp == rows[order[i]].stamp) continue;
+    unique_order.push_back(order[i]);
+  }
+  return unique_order;
+}
+
+
+static int64_t
+FindStamp(const vector<int64_t> &stamps, int64_t stamp)
+{
+  auto iter = lower_bound(stamps.begin(), stamps.end(), stamp);
+  if(iter == stamps.end() || *iter != stamp) return -1;
+  return iter - stamps.begin();
+}
+
+
+void
+ImuTable::clear()
+{
+  stamps_.clear();
+  orientation_.clear();
+  gyro_.clear();
+  accel_.clear();
+  mag_.clear();
+  has_motion_ = false;
+}
+
+
+void
+ImuTable::Build(const vector<ImuRow> &rows)
+{
+  clear();
+  vector<size_t> order = SortedRowOrder(rows);
+  for(size_t i : order) has_motion_ = has_motion_ || rows[i].fields == 17;
+
+  stamps_.reserve(order.size());
+  orientation_.reserve(order.size());
+  if(has_motion_){
+    gyro_.reserve(order.size());
+    accel_.reserve(order.size());
+    mag_.reserve(order.size());
+  }
+  for(size_t i : order){
+    const ImuRow &row = rows[i];
+    stamps_.push_back(row.stamp);
+    Quat q = {row.q[0], row.q[1], row.q[2], row.q[3]};
+    orientation_.push_back(q);
+    if(!has_motion_) continue;
+    Vec3 zero = {0.0, 0.0, 0.0};
+    Vec3 gyro = {row.gyro[0], row.gyro[1], row.gyro[2]};
+    Vec3 accel = {row.acc[0], row.acc[1], row.acc[2]};
+    Vec3 mag = {row.mag[0], row.mag[1], row.mag[2]};
+    gyro_.push_back(row.fields == 17 ? gyro : zero);
+    accel_.push_back(row.fields == 17 ? accel : zero);
+    mag_.push_back(row.fields == 17 ? mag : zero);
+  }
+}
+
+
+int64_t
+ImuTable::Find(int64_t stamp) const
+{
+  return FindStamp(stamps_, stamp);
+}
+
+
+size_t
+ImuTable::LowerBound(int64_t stamp) const
+{
+  return lower_bound(stamps_.begin(), stamps_.end(), stamp) - stamps_.begin();
+}
+
+
+void
+ImuTable::ToMsg(size_t i, sensor_msgs::Imu &msg) const
+{
+  msg.header.stamp.fromNSec(stamps_[i]);
+  msg.header.frame_id = "imu";
+  msg.orientation.x = orientation_[i].x;
+  msg.orientation.y = orientation_[i].y;
+  msg.orientation.z = orientation_[i].z;
+  msg.orientation.w = orientation_[i].w;
+  if(!has_motion_) return;
+
+  msg.angular_velocity.x = gyro_[i].x;
+  msg.angular_velocity.y = gyro_[i].y;
+  msg.angular_velocity.z = gyro_[i].z;
+  msg.linear_acceleration.x = accel_[i].x;
+  msg.linear_acceleration.y = accel_[i].y;
+  msg.linear_acceleration.z = accel_[i].z;
+
+  msg.orientation_covariance[0] = 3;
+  msg.orientation_covariance[4] = 3;
+  msg.orientation_covariance[8] = 3;
+  msg.angular_velocity_covariance[0] = 3;
+  msg.angular_velocity_covariance[4] = 3;
+  msg.angular_velocity_covariance[8] = 3;
+  msg.linear_acceleration_covariance[0] = 3;
+  msg.linear_acceleration_covariance[4] = 3;
+  msg.linear_acceleration_covariance[8] = 3;
+}
+
+
+void
+ImuTable::ToMsg(size_t i, sensor_msgs::MagneticField &msg) const
+{
+  msg.header.stamp.fromNSec(stamps_[i]);
+  msg.header.frame_id = "imu";
+  msg.magnetic_field.x = mag_[i].x;
+  msg.magnetic_field.y = mag_[i].y;
+  msg.magnetic_field.z = mag_[i].z;
+}
+
+
+size_t
+ImuTable::MemoryBytes() const
+{
+  return stamps_.capacity()*sizeof(int64_t) + orientation_.capacity()*sizeof(Quat)
+         + (gyro_.capacity() + accel_.capacity() + mag_.capacity())*sizeof(Vec3);
+}
+
+
+void
+GpsTable::clear()
+{
+  stamps_.clear();
+  latitude_.clear();
+  longitude_.clear();
+  altitude_.clear();
+  covariance_.clear();
+}
+
+
+void
+GpsTable::Build(const vector<GpsRow> &rows)
+{
+  clear();
+  vector<size_t> order = SortedRowOrder(rows);
+  stamps_.reserve(order.size());
+  latitude_.reserve(order.size());
+  longitude_.reserve(order.size());
+  altitude_.reserve(order.size());
+  covariance_.reserve(9*order.size());
+  for(size_t i : order){
+    stamps_.push_back(rows[i].stamp);
+    latitude_.push_back(rows[i].latitude);
+    longitude_.push_back(rows[i].longitude);
+    altitude_.push_back(rows[i].altitude);
+    covariance_.insert(covariance_.end(), rows[i].cov, rows[i].cov + 9);
+  }
+}
+
+
+int64_t
+GpsTable::Find(int64_t stamp) const
+{
+  return FindStamp(stamps_, stamp);
+}
+
+
+size_t
+GpsTable::LowerBound(int64_t stamp) const
+{
+  return lower_bound(stamps_.begin(), stamps_.end(), stamp) - stamps_.begin();
+}
+
+
+void
+GpsTable::ToMsg(size_t i, sensor_msgs::NavSatFix &msg) const
+{
+  msg.header.stamp.fromNSec(stamps_[i]);
+  msg.header.frame_id = "gps";
+  msg.latitude = latitude_[i];
+  msg.longitude = longitude_[i];
+  msg.altitude = altitude_[i];
+  for(int k = 0 ; k < 9 ; k ++) msg.position_covariance[k] = covariance_[9*i + k];
+}
+
+
+size_t
+GpsTable::MemoryBytes() const
+{
+  return stamps_.capacity()*sizeof(int64_t)
+         + (latitude_.capacity() + longitude_.capacity() + altitude_.capacity() + covariance_.capacity())*sizeof(double);
+}
+
+
+int 
+GetDirList(string dir, StampIndex &files)
+{
+  //file names are <stamp>.<ext>, keep the parsed stamps only
+  files.clear();
+  DIR *dp = opendir(dir.c_str());
+  if (dp == NULL)
+  {
+    string errmsg{(string{"No directory ("} + dir + string{")"})};
+    const char * ptr_errmsg = errmsg.c_str();
+    perror(ptr_errmsg);
+    return -1;
+  }
+
+  struct dirent *entry;
+  while ((entry = readdir(dp)) != NULL)
+  {
+    char *end = NULL;
+    errno = 0;
+    long long stamp = strtoll(entry->d_name, &end, 10);
+    if(end == entry->d_name || *end != '.' || errno != 0) continue;
+    files.stamps_.push_back(static_cast<int64_t>(stamp));
+  }
+  closedir(dp);
+
+  files.Build();
+  return 0;
+}
@@ -0,0 +1,216 @@
+#include "file_player/sequencecache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// files and directories (relative to sensor_data) the cache is derived from
+const char *kSources[SEQUENCE_CACHE_SOURCES] = {"data_stamp.csv", "gps.csv", "xsens_imu.csv", "Ouster", "radar/polar"};
+
+enum { SECTION_STAMP, SECTION_GPS, SECTION_IMU, SECTION_OUSTER, SECTION_RADARPOLAR, NUM_SECTIONS };
+
+struct CachedStampRow{
+  int64_t stamp;
+  char name[24];
+};
+
+struct CacheHeader{
+  char magic[8];
+  uint32_t version;
+  uint32_t has_imu;
+  uint32_t row_sizes[NUM_SECTIONS];  // guards against row layout changes without a version bump
+  uint32_t reserved;
+  SequenceSources sources;
+  uint64_t offsets[NUM_SECTIONS];
+  uint64_t counts[NUM_SECTIONS];
+};
+
+const char kMagic[8] = {'F', 'P', 'C', 'A', 'C', 'H', 'E', '\0'};
+
+void
+GetRowSizes(uint32_t *row_sizes)
+{
+  row_sizes[SECTION_STAMP] = sizeof(CachedStampRow);
+  row_sizes[SECTION_GPS] = sizeof(GpsRow);
+  row_sizes[SECTION_IMU] = sizeof(ImuRow);
+  row_sizes[SECTION_OUSTER] = sizeof(int64_t);
+  row_sizes[SECTION_RADARPOLAR] = sizeof(int64_t);
+}
+
+template <typename T>
+void
+CopySection(const MappedFile &file, const CacheHeader &header, int section, vector<T> &out)
+{
+  const T *begin = reinterpret_cast<const T *>(file.data() + header.offsets[section]);
+  out.assign(begin, begin + header.counts[section]);
+}
+
+template <typename T>
+bool
+WriteSection(FILE *fp, const vector<T> &rows)
+{
+  return rows.empty() || fwrite(rows.data(), sizeof(T), rows.size(), fp) == rows.size();
+}
+
+// ImuRow has padding after fields : the rows go through a zeroed buffer, field by field,
+// so the file never carries uninitialized bytes
+bool
+WriteImuSection(FILE *fp, const vector<ImuRow> &rows)
+{
+  vector<ImuRow> buffer(min<size_t>(rows.size(), 4096));
+  for(size_t begin = 0 ; begin < rows.size() ; begin += buffer.size()){
+    size_t count = min(buffer.size(), rows.size() - begin);
+    memset(buffer.data(), 0, count * sizeof(ImuRow));
+    for(size_t i = 0 ; i < count ; i ++){
+      const ImuRow &row = rows[begin + i];
+      ImuRow &out = buffer[i];
+      out.stamp = row.stamp;
+      out.fields = row.fields;
+      memcpy(out.q, row.q, sizeof(out.q));
+      memcpy(out.euler, row.euler, sizeof(out.euler));
+      if(row.fields > 8){
+        memcpy(out.gyro, row.gyro, sizeof(out.gyro));
+        memcpy(out.acc, row.acc, sizeof(out.acc));
+        memcpy(out.mag, row.mag, sizeof(out.mag));
+      }
+    }
+    if(fwrite(buffer.data(), sizeof(ImuRow), count, fp) != count) return false;
+  }
+  return true;
+}
+
+} // namespace
+
+
+bool
+LoadSequenceCache(const string &data_folder, bool need_imu, SequenceTables &tables)
+{
+  const string sensor_dir = data_folder + "/sensor_data";
+  MappedFile file;
+  if(!file.Open(sensor_dir + "/" + SEQUENCE_CACHE_NAME) || file.size() < sizeof(CacheHeader)) return false;
+
+  CacheHeader header;
+  memcpy(&header, file.data(), sizeof(header));
+  if(memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != SEQUENCE_CACHE_VERSION) return false;
+  if(need_imu && !header.has_imu) return false;
+
+  uint32_t row_sizes[NUM_SECTIONS];
+  GetRowSizes(row_sizes);
+  if(memcmp(header.row_sizes, row_sizes, sizeof(row_sizes)) != 0) return false;
+
+  SequenceSources sources;
+  GetSequenceSources(data_folder, sources);
+  if(memcmp(&header.sources, &sources, sizeof(sources)) != 0) return false;
+
+  for(int i = 0 ; i < NUM_SECTIONS ; i ++){
+    if(header.offsets[i] % sizeof(int64_t) != 0 || header.offsets[i] > file.size()) return false;
+    if(header.counts[i] > (file.size() - header.offsets[i]) / row_sizes[i]) return false;
+  }
+
+  vector<CachedStampRow> stamp_rows;
+  CopySection(file, header, SECTION_STAMP, stamp_rows);
+  tables.stamps.resize(stamp_rows.size());
+  for(size_t i = 0 ; i < stamp_rows.size() ; i ++){
+    tables.stamps[i].stamp = stamp_rows[i].stamp;
+    tables.stamps[i].name.assign(stamp_rows[i].name, strnlen(stamp_rows[i].name, sizeof(stamp_rows[i].name)));
+  }
+  CopySection(file, header, SECTION_GPS, tables.gps);
+  CopySection(file, header, SECTION_IMU, tables.imu);
+  CopySection(file, header, SECTION_OUSTER, tables.ouster_stamps);
+  CopySection(file, header, SECTION_RADARPOLAR, tables.radarpolar_stamps);
+  tables.has_imu = header.has_imu != 0;
+  return true;
+}
+
+
+void
+GetSequenceSources(const string &data_folder, SequenceSources &sources)
+{
+  const string sensor_dir = data_folder + "/sensor_data";
+  for(int i = 0 ; i < SEQUENCE_CACHE_SOURCES ; i ++){
+    struct stat st;
+    if(stat((sensor_dir + "/" + kSources[i]).c_str(), &st) != 0){
+      sources.files[i].size = -1;
+      sources.files[i].mtime_ns = -1;
+      continue;
+    }
+    sources.files[i].size = static_cast<int64_t>(st.st_size);
+    sources.files[i].mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec)*1000000000LL + st.st_mtim.tv_nsec;
+  }
+}
+
+
+string
+SequenceSourceDigest(const string &data_folder)
+{
+  SequenceSources sources;
+  GetSequenceSources(data_folder, sources);
+  // FNV-1a over the size and mtime of every source (the CSV files and the Ouster and radar/polar
+  // directories, -1 for a missing one); SequenceSources has no padding, its bytes are those fields
+  uint64_t hash = 1469598103934665603ULL;
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&sources);
+  for(size_t i = 0 ; i < sizeof(sources) ; i ++){
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  char digest[17];
+  snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(hash));
+  return digest;
+}
+
+
+bool
+SaveSequenceCache(const string &data_folder, const SequenceSources &sources, const SequenceTables &tables)
+{
+  const string sensor_dir = data_folder + "/sensor_data";
+  const string path = sensor_dir + "/" + SEQUENCE_CACHE_NAME;
+  const string tmp_path = path + ".tmp";
+
+  vector<CachedStampRow> stamp_rows(tables.stamps.size());
+  for(size_t i = 0 ; i < tables.stamps.size() ; i ++){
+    memset(&stamp_rows[i], 0, sizeof(CachedStampRow));
+    stamp_rows[i].stamp = tables.stamps[i].stamp;
+    if(tables.stamps[i].name.size() >= sizeof(stamp_rows[i].name)) return false;
+    memcpy(stamp_rows[i].name, tables.stamps[i].name.data(), tables.stamps[i].name.size());
+  }
+
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = SEQUENCE_CACHE_VERSION;
+  header.has_imu = tables.has_imu;
+  GetRowSizes(header.row_sizes);
+  header.sources = sources;
+  header.counts[SECTION_STAMP] = stamp_rows.size();
+  header.counts[SECTION_GPS] = tables.gps.size();
+  header.counts[SECTION_IMU] = tables.imu.size();
+  header.counts[SECTION_OUSTER] = tables.ouster_stamps.size();
+  header.counts[SECTION_RADARPOLAR] = tables.radarpolar_stamps.size();
+  uint64_t offset = sizeof(CacheHeader);
+  for(int i = 0 ; i < NUM_SECTIONS ; i ++){
+    header.offsets[i] = offset;
+    offset += header.counts[i] * header.row_sizes[i];
+  }
+
+  FILE *fp = fopen(tmp_path.c_str(), "wb");
+  if(fp == NULL) return false;
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+            && WriteSection(fp, stamp_rows)
+            && WriteSection(fp, tables.gps)
+            && WriteImuSection(fp, tables.imu)
+            && WriteSection(fp, tables.ouster_stamps)
+            && WriteSection(fp, tables.radarpolar_stamps);
+  ok = (fclose(fp) == 0) && ok;
+  if(!ok || rename(tmp_path.c_str(), path.c_str()) != 0){
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,415 @@
+#include "file_player/bagexporter.h"
+#include "file_player/csvparser.h"
+#include "file_player/exportcheckpoint.h"
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+const int64_t kStart = 1561000000000000000LL;
+const int64_t kMs = 1000000LL;
+
+class PlanSplitsTest : public ::testing::Test{
+
+protected:
+  void SetUp() override {
+    char folder[] = "/tmp/plansplits_testXXXXXX";
+    ASSERT_TRUE(mkdtemp(folder) != NULL);
+    folder_ = folder;
+    dirs_.push_back(folder_);
+    dirs_.push_back(folder_ + "/sensor_data");
+    dirs_.push_back(folder_ + "/sensor_data/Ouster");
+    dirs_.push_back(folder_ + "/sensor_data/radar");
+    dirs_.push_back(folder_ + "/sensor_data/radar/polar");
+    for(size_t i = 1 ; i < dirs_.size() ; i ++) ASSERT_EQ(0, mkdir(dirs_[i].c_str(), 0755));
+    sequence_.data_folder_path_ = folder_;
+    options_.output_path = folder_ + "/out.bag";
+    options_.imu = false;
+    options_.ouster = false;
+  }
+
+  void TearDown() override {
+    for(size_t i = 0 ; i < files_.size() ; i ++) unlink(files_[i].c_str());
+    for(size_t i = dirs_.size() ; i -- > 0 ; ) rmdir(dirs_[i].c_str());
+  }
+
+  void WriteFile(const std::string &path, size_t bytes){
+    FILE *fp = fopen(path.c_str(), "wb");
+    ASSERT_TRUE(fp != NULL);
+    std::vector<char> data(bytes, 7);
+    EXPECT_EQ(bytes, fwrite(data.data(), 1, data.size(), fp));
+    fclose(fp);
+    files_.push_back(path);
+  }
+
+  // LiDAR files of points points each, the split estimate is points * PointLayoutStep
+  void AddOuster(int64_t stamp, size_t points){
+    WriteFile(sequence_.OusterPath(stamp), points * OUSTER_BIN_POINT_SIZE);
+    sequence_.ouster_file_stamps_.stamps_.push_back(stamp);
+    sequence_.ouster_file_stamps_.Build();
+  }
+
+  void AddRadar(int64_t stamp, size_t bytes){
+    WriteFile(sequence_.RadarpolarPath(stamp), bytes);
+    sequence_.radarpolar_file_stamps_.stamps_.push_back(stamp);
+    sequence_.radarpolar_file_stamps_.Build();
+  }
+
+  void AddImu(int64_t first, int64_t last, int64_t period){
+    std::vector<ImuRow> rows;
+    for(int64_t stamp = first ; stamp <= last ; stamp += period){
+      ImuRow row = ImuRow();
+      row.stamp = stamp;
+      row.fields = 8;
+      row.q[3] = 1.0;
+      rows.push_back(row);
+    }
+    sequence_.imu_data_.Build(rows);
+  }
+
+  std::string folder_;
+  std::vector<std::string> dirs_;
+  std::vector<std::string> files_;
+  MulranSequence sequence_;
+  ExportOptions options_;
+};
+
+// the ranges tile [first, last] in order, without gaps or overlaps
+void
+ExpectTiled(const std::vector<ExportRange> &ranges, int64_t first, int64_t last)
+{
+  ASSERT_FALSE(ranges.empty());
+  EXPECT_EQ(first, ranges.front().first);
+  EXPECT_EQ(last, ranges.back().last);
+  for(size_t k = 0 ; k < ranges.size() ; k ++){
+    EXPECT_LE(ranges[k].first, ranges[k].last) << "range " << k;
+    if(k + 1 < ranges.size()){
+      EXPECT_EQ(ranges[k].last + 1, ranges[k + 1].first) << "range " << k;
+    }
+  }
+}
+
+} // namespace
+
+
+TEST(SplitBagPath, NumbersTheStem)
+{
+  EXPECT_EQ("/data/run_000.bag", SplitBagPath("/data/run.bag", 0));
+  EXPECT_EQ("/data/run_012.bag", SplitBagPath("/data/run.bag", 12));
+  EXPECT_EQ("/data/run_001", SplitBagPath("/data/run", 1));
+}
+
+TEST_F(PlanSplitsTest, NoCriterionIsOneRange)
+{
+  options_.imu = true;
+  options_.ouster = true;
+  AddImu(kStart, kStart + 5000 * kMs, 10 * kMs);
+  for(int k = 0 ; k < 50 ; k ++) AddOuster(kStart + k * 100 * kMs, 64);
+
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, kStart + 5000 * kMs);
+  ASSERT_EQ(1u, ranges.size());
+  EXPECT_EQ(kStart, ranges[0].first);
+  EXPECT_EQ(kStart + 5000 * kMs, ranges[0].last);
+  EXPECT_EQ(kStart, ranges[0].imu_first);
+  EXPECT_EQ(kStart + 5000 * kMs, ranges[0].imu_last);
+  EXPECT_EQ(SplitBagPath(options_.output_path, 0), ranges[0].path);
+}
+
+TEST_F(PlanSplitsTest, CutsByDuration)
+{
+  options_.imu = true;
+  options_.ouster = true;
+  options_.split_duration = 3000 * kMs;
+  options_.split_overlap = 0;
+  const int64_t last = kStart + 9950 * kMs;
+  AddImu(kStart, last, 10 * kMs);
+  for(int k = 0 ; k < 100 ; k ++) AddOuster(kStart + 5 * kMs + k * 100 * kMs, 64);
+
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, last);
+  ExpectTiled(ranges, kStart, last);
+  // the first message at or past each 3 s mark starts a bag
+  ASSERT_EQ(4u, ranges.size());
+  for(size_t k = 0 ; k < ranges.size() ; k ++){
+    EXPECT_EQ(kStart + static_cast<int64_t>(k) * 3000 * kMs, ranges[k].first);
+    EXPECT_EQ(ranges[k].first, ranges[k].imu_first);
+    EXPECT_EQ(ranges[k].last, ranges[k].imu_last);
+    EXPECT_EQ(SplitBagPath(options_.output_path, k), ranges[k].path);
+  }
+}
+
+TEST_F(PlanSplitsTest, DurationCountsFromTheFirstMessage)
+{
+  options_.ouster = true;
+  options_.split_duration = 1000 * kMs;
+  // nothing before 2.5 s, then a scan every 300 ms
+  for(int k = 0 ; k < 10 ; k ++) AddOuster(kStart + 2500 * kMs + k * 300 * kMs, 64);
+
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, kStart + 6000 * kMs);
+  ExpectTiled(ranges, kStart, kStart + 6000 * kMs);
+  // 2.5 s, 3.7 s (first >= 3.5 s), 4.9 s (first >= 4.7 s)
+  ASSERT_EQ(3u, ranges.size());
+  EXPECT_EQ(kStart, ranges[0].first);
+  EXPECT_EQ(kStart + 3700 * kMs, ranges[1].first);
+  EXPECT_EQ(kStart + 4900 * kMs, ranges[2].first);
+}
+
+TEST_F(PlanSplitsTest, CutsBySizeNeverBetweenEqualStamps)
+{
+  options_.ouster = true;
+  options_.radar = true;
+  // every scan and every radar image is estimated at one unit
+  const size_t points = 100;
+  const uint64_t unit = points * PointLayoutStep(POINT_LAYOUT_FULL);
+  options_.split_bytes = unit * 5 / 2;
+  // scans every 100 ms, radar every 200 ms on the same stamps as the even scans
+  for(int k = 0 ; k < 10 ; k ++) AddOuster(kStart + k * 100 * kMs, points);
+  for(int k = 0 ; k < 5 ; k ++) AddRadar(kStart + k * 200 * kMs, unit);
+
+  const int64_t last = kStart + 1000 * kMs;
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, last);
+  ExpectTiled(ranges, kStart, last);
+  // the budget runs out on the radar image of every even stamp, which stays with its
+  // scan : the bag is cut at the next stamp instead
+  const int64_t starts[] = {0, 100, 300, 500, 700, 900};
+  ASSERT_EQ(sizeof(starts) / sizeof(starts[0]), ranges.size());
+  for(size_t k = 0 ; k < ranges.size() ; k ++) EXPECT_EQ(kStart + starts[k] * kMs, ranges[k].first) << "range " << k;
+}
+
+TEST_F(PlanSplitsTest, SizeAndDurationTogether)
+{
+  options_.ouster = true;
+  const size_t points = 100;
+  const uint64_t unit = points * PointLayoutStep(POINT_LAYOUT_FULL);
+  options_.split_bytes = unit * 4;
+  options_.split_duration = 250 * kMs;
+  for(int k = 0 ; k < 20 ; k ++) AddOuster(kStart + k * 100 * kMs, points);
+
+  const int64_t last = kStart + 1999 * kMs;
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, last);
+  ExpectTiled(ranges, kStart, last);
+  // the duration cuts first, every third scan
+  ASSERT_EQ(7u, ranges.size());
+  for(size_t k = 0 ; k < ranges.size() ; k ++) EXPECT_EQ(kStart + static_cast<int64_t>(k) * 300 * kMs, ranges[k].first);
+
+  // a layout with a smaller step fits more scans under the same budget
+  options_.split_duration = 0;
+  options_.split_bytes = unit * 2;
+  EXPECT_EQ(10u, PlanSplits(sequence_, options_, kStart, last).size());
+  options_.point_layout = POINT_LAYOUT_XYZ16;
+  EXPECT_LT(PlanSplits(sequence_, options_, kStart, last).size(), 10u);
+}
+
+TEST_F(PlanSplitsTest, ImuOverlapsTheBoundaries)
+{
+  options_.imu = true;
+  options_.ouster = true;
+  options_.split_duration = 2000 * kMs;
+  options_.split_overlap = 500 * kMs;
+  const int64_t last = kStart + 5990 * kMs;
+  AddImu(kStart, last, 10 * kMs);
+  for(int k = 0 ; k < 60 ; k ++) AddOuster(kStart + k * 100 * kMs, 64);
+
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, last);
+  ExpectTiled(ranges, kStart, last);
+  ASSERT_EQ(3u, ranges.size());
+  // the outer ends are not widened past the export range
+  EXPECT_EQ(kStart, ranges[0].imu_first);
+  EXPECT_EQ(last, ranges[2].imu_last);
+  for(size_t k = 0 ; k + 1 < ranges.size() ; k ++){
+    EXPECT_EQ(ranges[k].last + 500 * kMs, ranges[k].imu_last) << "range " << k;
+    EXPECT_EQ(ranges[k + 1].first - 500 * kMs, ranges[k + 1].imu_first) << "range " << k + 1;
+  }
+
+  // an overlap longer than the neighbour bags stops at the export range
+  options_.split_overlap = 10000 * kMs;
+  ranges = PlanSplits(sequence_, options_, kStart, last);
+  ASSERT_EQ(3u, ranges.size());
+  for(size_t k = 0 ; k < ranges.size() ; k ++){
+    EXPECT_EQ(kStart, ranges[k].imu_first);
+    EXPECT_EQ(last, ranges[k].imu_last);
+  }
+}
+
+TEST_F(PlanSplitsTest, EmptyRangeIsOneBag)
+{
+  options_.ouster = true;
+  options_.split_duration = 1000 * kMs;
+  AddOuster(kStart + 9000 * kMs, 64);
+
+  std::vector<ExportRange> ranges = PlanSplits(sequence_, options_, kStart, kStart + 5000 * kMs);
+  ASSERT_EQ(1u, ranges.size());
+  EXPECT_EQ(kStart, ranges[0].first);
+  EXPECT_EQ(kStart + 5000 * kMs, ranges[0].last);
+}
+
+namespace {
+
+// Whole exports of an IMU-only sequence into split bags
+class ExportResumeTest : public PlanSplitsTest{
+
+protected:
+  void SetUp() override {
+    PlanSplitsTest::SetUp();
+    AddImu(kStart, kStart + 2990 * kMs, 10 * kMs);
+    sequence_.initial_data_stamp_ = kStart;
+    sequence_.last_data_stamp_ = kStart + 2990 * kMs;
+    options_.imu = true;
+    options_.split_duration = 1000 * kMs;
+    options_.split_overlap = 0;
+    options_.split_writers = 1;
+    options_.checkpoint_period = 0;
+    for(size_t k = 0 ; k < 3 ; k ++){
+      files_.push_back(SplitBagPath(options_.output_path, k));
+      files_.push_back(SplitBagPath(options_.output_path, k) + EXPORT_CHECKPOINT_SUFFIX);
+    }
+    files_.push_back(options_.output_path + EXPORT_MANIFEST_SUFFIX);
+  }
+
+  // set the bags back in time, so the ones written again stand out
+  void AgeBags(){
+    for(size_t k = 0 ; k < 3 ; k ++){
+      struct timeval times[2] = {{1000000000, 0}, {1000000000, 0}};
+      ASSERT_EQ(0, utimes(SplitBagPath(options_.output_path, k).c_str(), times));
+    }
+  }
+
+  // stamps of the messages in the first segments segments of the unsplit output, in order
+  std::vector<int64_t> BagStamps(size_t segments){
+    std::vector<int64_t> stamps;
+    for(size_t s = 0 ; s < segments ; s ++){
+      rosbag::Bag bag;
+      bag.open(ExportSegmentPath(options_.output_path, s), rosbag::bagmode::Read);
+      rosbag::View view(bag);
+      for(const rosbag::MessageInstance &m : view) stamps.push_back(static_cast<int64_t>(m.getTime().toNSec()));
+      bag.close();
+    }
+    return stamps;
+  }
+
+  // bags written since AgeBags()
+  std::vector<size_t> Rewritten(){
+    std::vector<size_t> rewritten;
+    for(size_t k = 0 ; k < 3 ; k ++){
+      struct stat st;
+      if(stat(SplitBagPath(options_.output_path, k).c_str(), &st) == 0 && st.st_mtime != 1000000000) rewritten.push_back(k);
+    }
+    return rewritten;
+  }
+};
+
+} // namespace
+
+
+TEST_F(ExportResumeTest, KeepsCompleteBags)
+{
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  ExportManifest manifest;
+  ASSERT_TRUE(LoadExportManifest(options_.output_path, manifest));
+  ASSERT_EQ(3u, manifest.bags.size());
+  for(size_t k = 0 ; k < 3 ; k ++){
+    ExportCheckpoint checkpoint;
+    ASSERT_TRUE(LoadExportCheckpoint(SplitBagPath(options_.output_path, k), checkpoint)) << "bag " << k;
+    EXPECT_TRUE(ExportCheckpointValid(SplitBagPath(options_.output_path, k), checkpoint)) << "bag " << k;
+    EXPECT_TRUE(checkpoint.complete) << "bag " << k;
+    ASSERT_EQ(1u, checkpoint.segments.size()) << "bag " << k;
+    EXPECT_EQ(manifest.bags[k].second, checkpoint.segments[0].size) << "bag " << k;
+  }
+
+  // unchanged : nothing is written
+  AgeBags();
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  EXPECT_TRUE(Rewritten().empty());
+
+  // an export interrupted while writing the second bag : it has no checkpoint and no manifest
+  // was written, only that bag and the one after it are written again
+  RemoveExportManifest(options_.output_path);
+  RemoveExportCheckpoint(SplitBagPath(options_.output_path, 1));
+  unlink(SplitBagPath(options_.output_path, 2).c_str());
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  EXPECT_EQ(std::vector<size_t>({1, 2}), Rewritten());
+  ASSERT_TRUE(LoadExportManifest(options_.output_path, manifest));
+  EXPECT_TRUE(ExportManifestValid(manifest));
+
+  // a bag damaged after the export
+  AgeBags();
+  ASSERT_EQ(0, truncate(SplitBagPath(options_.output_path, 0).c_str(), 100));
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  EXPECT_EQ(std::vector<size_t>({0}), Rewritten());
+}
+
+TEST_F(ExportResumeTest, OtherOptionsWriteEverything)
+{
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  RemoveExportManifest(options_.output_path);
+  AgeBags();
+  options_.split_overlap = 100 * kMs;
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2}), Rewritten());
+
+  AgeBags();
+  options_.resume = false;
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  EXPECT_EQ(std::vector<size_t>({0, 1, 2}), Rewritten());
+}
+
+TEST_F(ExportResumeTest, InterruptedBagGoesOnInContinuationSplits)
+{
+  // a single bag, closed and checkpointed every 10 ms while writing
+  options_.split_duration = 0;
+  options_.checkpoint_period = 0.01;
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  ExportCheckpoint full;
+  ASSERT_TRUE(LoadExportCheckpoint(options_.output_path, full));
+  const size_t segments = full.segments.size();
+  files_.push_back(options_.output_path + EXPORT_CHECKPOINT_SUFFIX);
+  for(size_t s = 0 ; s < segments ; s ++) files_.push_back(ExportSegmentPath(options_.output_path, s));
+  ASSERT_GE(segments, 3u) << "the export should take several checkpoint periods";
+  EXPECT_TRUE(full.complete);
+  EXPECT_EQ(sequence_.imu_data_.stamps_.back(), full.segments.back().last_stamp[EXPORT_IMU]);
+  const std::vector<int64_t> stamps = BagStamps(segments);
+  EXPECT_EQ(std::vector<int64_t>(sequence_.imu_data_.stamps_.begin(), sequence_.imu_data_.stamps_.end()), stamps);
+
+  // interrupted while writing the third segment : only two are recorded, the third is unclosed
+  ExportCheckpoint interrupted = full;
+  interrupted.segments.resize(2);
+  interrupted.complete = false;
+  ASSERT_TRUE(SaveExportCheckpoint(options_.output_path, interrupted));
+  RemoveExportManifest(options_.output_path);
+  for(size_t s = 2 ; s < segments ; s ++) unlink(ExportSegmentPath(options_.output_path, s).c_str());
+  FILE *fp = fopen(ExportSegmentPath(options_.output_path, 2).c_str(), "wb");
+  ASSERT_TRUE(fp != NULL);
+  fputs("unclosed", fp);
+  fclose(fp);
+  struct timeval times[2] = {{1000000000, 0}, {1000000000, 0}};
+  for(size_t s = 0 ; s < 2 ; s ++) ASSERT_EQ(0, utimes(ExportSegmentPath(options_.output_path, s).c_str(), times));
+
+  // the closed segments are kept, the rest goes on right after them
+  options_.checkpoint_period = 0;
+  ASSERT_TRUE(ExportBag(sequence_, options_));
+  ExportCheckpoint resumed;
+  ASSERT_TRUE(LoadExportCheckpoint(options_.output_path, resumed));
+  EXPECT_TRUE(resumed.complete);
+  ASSERT_EQ(3u, resumed.segments.size());
+  for(size_t s = 0 ; s < 2 ; s ++){
+    struct stat st;
+    ASSERT_EQ(0, stat(ExportSegmentPath(options_.output_path, s).c_str(), &st));
+    EXPECT_EQ(1000000000, st.st_mtime) << "segment " << s;
+  }
+  EXPECT_EQ(stamps, BagStamps(3));
+
+  ExportManifest manifest;
+  ASSERT_TRUE(LoadExportManifest(options_.output_path, manifest));
+  ASSERT_EQ(3u, manifest.bags.size());
+  EXPECT_EQ(ExportSegmentPath(options_.output_path, 2), manifest.bags[2].first);
+  EXPECT_TRUE(ExportManifestValid(manifest));
+}
@@ -0,0 +1,242 @@
+#include "file_player/cloudreduction.h"
+
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <gtest/gtest.h>
+
+namespace {
+
+sensor_msgs::PointCloud2
+MakeCloud(const std::vector<OusterPoint> &points)
+{
+  sensor_msgs::PointCloud2 cloud;
+  InitOusterCloud(cloud, points.size());
+  std::copy(points.begin(), points.end(), reinterpret_cast<OusterPoint *>(cloud.data.data()));
+  return cloud;
+}
+
+std::vector<OusterPoint>
+Points(const sensor_msgs::PointCloud2 &cloud)
+{
+  const OusterPoint *begin = reinterpret_cast<const OusterPoint *>(cloud.data.data());
+  return std::vector<OusterPoint>(begin, begin + cloud.data.size() / sizeof(OusterPoint));
+}
+
+OusterPoint
+Point(float x, float y, float z, float intensity, uint32_t t = 0, int32_t ring = 1)
+{
+  OusterPoint p = {x, y, z, intensity, t, ring};
+  return p;
+}
+
+// column-major scan of columns x 64 points spread over +-50 m, t and ring as decoded
+std::vector<OusterPoint>
+MakeScan(size_t columns)
+{
+  std::vector<OusterPoint> points;
+  uint64_t x = 12345;
+  for(size_t k = 0 ; k < columns * OUSTER_CHANNELS ; k ++){
+    float v[4];
+    for(int i = 0 ; i < 4 ; i ++){
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      v[i] = static_cast<float>(x % 100000) / 1000.0f - 50.0f;
+    }
+    points.push_back(Point(v[0], v[1], v[2] / 10.0f, v[3] + 50.0f, static_cast<uint32_t>(k / OUSTER_CHANNELS),
+                           static_cast<int32_t>(k % OUSTER_CHANNELS) + 1));
+  }
+  return points;
+}
+
+// straightforward voxel grid : centroids in order of first appearance
+std::vector<OusterPoint>
+ReferenceVoxels(const std::vector<OusterPoint> &points, float size)
+{
+  typedef std::tuple<int64_t, int64_t, int64_t> Key;
+  std::map<Key, size_t> index;
+  std::vector<OusterPoint> sums;
+  std::vector<uint32_t> counts;
+  const float inv = 1.0f / size;
+  for(const OusterPoint &p : points){
+    if(!(std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z))) continue;
+    Key key(static_cast<int64_t>(std::floor(p.x * inv)), static_cast<int64_t>(std::floor(p.y * inv)),
+            static_cast<int64_t>(std::floor(p.z * inv)));
+    auto found = index.find(key);
+    if(found == index.end()){
+      index[key] = sums.size();
+      sums.push_back(p);
+      counts.push_back(1);
+      continue;
+    }
+    OusterPoint &sum = sums[found->second];
+    sum.x += p.x;
+    sum.y += p.y;
+    sum.z += p.z;
+    sum.intensity += p.intensity;
+    counts[found->second]++;
+  }
+  for(size_t i = 0 ; i < sums.size() ; i ++){
+    float inv_count = 1.0f / counts[i];
+    sums[i].x *= inv_count;
+    sums[i].y *= inv_count;
+    sums[i].z *= inv_count;
+    sums[i].intensity *= inv_count;
+  }
+  return sums;
+}
+
+// voxels come out grouped by thread : compare them in (t, ring) order of their first point
+bool
+ByFirstPoint(const OusterPoint &a, const OusterPoint &b)
+{
+  return a.t < b.t || (a.t == b.t && a.ring < b.ring);
+}
+
+void
+ExpectSamePoints(std::vector<OusterPoint> expected, std::vector<OusterPoint> actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  std::sort(expected.begin(), expected.end(), ByFirstPoint);
+  std::sort(actual.begin(), actual.end(), ByFirstPoint);
+  for(size_t i = 0 ; i < expected.size() ; i ++){
+    ASSERT_EQ(expected[i].t, actual[i].t) << i;
+    ASSERT_EQ(expected[i].ring, actual[i].ring) << i;
+    EXPECT_FLOAT_EQ(expected[i].x, actual[i].x) << i;
+    EXPECT_FLOAT_EQ(expected[i].y, actual[i].y) << i;
+    EXPECT_FLOAT_EQ(expected[i].z, actual[i].z) << i;
+    EXPECT_FLOAT_EQ(expected[i].intensity, actual[i].intensity) << i;
+  }
+}
+
+} // namespace
+
+
+TEST(VoxelReduce, CentroidsAndFirstPointFields)
+{
+  std::vector<OusterPoint> points;
+  points.push_back(Point(0.1f, 0.1f, 0.1f, 10.0f, 5, 3));
+  points.push_back(Point(2.5f, 0.5f, 0.5f, 7.0f, 6, 4));    // voxel (2, 0, 0)
+  points.push_back(Point(0.3f, 0.5f, 0.9f, 20.0f, 7, 5));   // voxel (0, 0, 0) again
+  points.push_back(Point(-0.5f, 0.5f, 0.5f, 1.0f, 8, 6));   // negative side : voxel (-1, 0, 0)
+  points.push_back(Point(std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f, 1.0f, 9, 7));  // dropped
+  sensor_msgs::PointCloud2 in = MakeCloud(points), out;
+
+  ReductionOptions options;
+  options.voxel_size = 1.0f;
+  ReductionScratch scratch;
+  ASSERT_EQ(3u, ReduceCloud(in, out, options, scratch));
+  std::vector<OusterPoint> voxels = Points(out);
+  ASSERT_EQ(3u, voxels.size());
+  EXPECT_EQ(sizeof(OusterPoint), out.point_step);
+
+  EXPECT_FLOAT_EQ(0.2f, voxels[0].x);
+  EXPECT_FLOAT_EQ(0.3f, voxels[0].y);
+  EXPECT_FLOAT_EQ(0.5f, voxels[0].z);
+  EXPECT_FLOAT_EQ(15.0f, voxels[0].intensity);
+  EXPECT_EQ(5u, voxels[0].t);    // of the first point in the voxel
+  EXPECT_EQ(3, voxels[0].ring);
+  EXPECT_FLOAT_EQ(2.5f, voxels[1].x);
+  EXPECT_EQ(6u, voxels[1].t);
+  EXPECT_FLOAT_EQ(-0.5f, voxels[2].x);
+  EXPECT_EQ(8u, voxels[2].t);
+}
+
+TEST(VoxelReduce, MatchesReference)
+{
+  std::vector<OusterPoint> points = MakeScan(1024);
+  sensor_msgs::PointCloud2 in = MakeCloud(points), out;
+  ReductionScratch scratch;
+  const float sizes[] = {0.5f, 2.0f, 10.0f};
+  for(float size : sizes){
+    ReductionOptions options;
+    options.voxel_size = size;
+    ReduceCloud(in, out, options, scratch);
+    ExpectSamePoints(ReferenceVoxels(points, size), Points(out));
+  }
+}
+
+// the scan split over threads (voxels shared out by key hash) gives the same voxels
+TEST(VoxelReduce, ThreadsGiveTheSameVoxels)
+{
+  std::vector<OusterPoint> points = MakeScan(1024);
+  sensor_msgs::PointCloud2 in = MakeCloud(points), single, parallel;
+  ReductionOptions options;
+  options.voxel_size = 1.0f;
+  ReductionScratch scratch;
+  size_t n = ReduceCloud(in, single, options, scratch);
+  for(int threads = 2 ; threads <= 8 ; threads *= 2){
+    options.threads = threads;
+    EXPECT_EQ(n, ReduceCloud(in, parallel, options, scratch));
+    ExpectSamePoints(Points(single), Points(parallel));
+  }
+}
+
+// the worker threads are started once and kept for the next scans, small scans need none
+TEST(VoxelReduce, WorkersAreKept)
+{
+  ReductionOptions options;
+  options.voxel_size = 1.0f;
+  options.threads = 4;
+  ReductionScratch scratch;
+  sensor_msgs::PointCloud2 small = MakeCloud(MakeScan(16)), large = MakeCloud(MakeScan(1024)), out;
+  ReduceCloud(small, out, options, scratch);
+  EXPECT_FALSE(scratch.workers);
+
+  ReduceCloud(large, out, options, scratch);
+  ASSERT_TRUE(scratch.workers != NULL);
+  const ReductionWorkers *workers = scratch.workers.get();
+  for(int i = 0 ; i < 20 ; i ++){
+    ReduceCloud(large, out, options, scratch);
+    options.voxel_size = (i % 2) ? 1.0f : 0.0f;
+  }
+  EXPECT_EQ(workers, scratch.workers.get());
+}
+
+TEST(CloudReduction, DecimationAndCrops)
+{
+  std::vector<OusterPoint> points = MakeScan(16);
+  sensor_msgs::PointCloud2 in = MakeCloud(points), out;
+  ReductionScratch scratch;
+
+  ReductionOptions options;
+  options.ring_step = 4;
+  options.column_step = 2;
+  ASSERT_EQ(16u / 2 * 64 / 4, ReduceCloud(in, out, options, scratch));
+  for(const OusterPoint &p : Points(out)){
+    EXPECT_EQ(0, (p.ring - 1) % 4);
+    EXPECT_EQ(0u, p.t % 2);
+  }
+
+  options = ReductionOptions();
+  options.min_range = 10.0f;
+  options.max_range = 40.0f;
+  options.use_box = true;
+  options.box_min[0] = -100.0f; options.box_min[1] = 0.0f; options.box_min[2] = -100.0f;
+  options.box_max[0] = 100.0f; options.box_max[1] = 100.0f; options.box_max[2] = 100.0f;
+  size_t expected = 0;
+  for(const OusterPoint &p : points){
+    float r = std::sqrt(p.x*p.x + p.y*p.y + p.z*p.z);
+    if(r >= 10.0f && r <= 40.0f && p.y >= 0.0f) expected++;
+  }
+  ASSERT_EQ(expected, ReduceCloud(in, out, options, scratch));
+  for(const OusterPoint &p : Points(out)){
+    float r = std::sqrt(p.x*p.x + p.y*p.y + p.z*p.z);
+    EXPECT_GE(r, 10.0f - 1e-4f);
+    EXPECT_LE(r, 40.0f + 1e-4f);
+    EXPECT_GE(p.y, 0.0f);
+  }
+}
+
+TEST(CloudReduction, DefaultOptionsKeepEveryPoint)
+{
+  std::vector<OusterPoint> points = MakeScan(4);
+  sensor_msgs::PointCloud2 in = MakeCloud(points), out;
+  ReductionScratch scratch;
+  ASSERT_EQ(points.size(), ReduceCloud(in, out, ReductionOptions(), scratch));
+  EXPECT_EQ(in.data, out.data);
+}
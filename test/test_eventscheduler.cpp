@@ -0,0 +1,54 @@
+#include "file_player/eventscheduler.h"
+
+#include <thread>
+#include <gtest/gtest.h>
+
+namespace {
+
+typedef EventScheduler::Clock Clock;
+
+} // namespace
+
+
+TEST(EventScheduler, WaitUntilReachesTheDeadline)
+{
+  EventScheduler scheduler;
+  uint64_t generation = scheduler.Generation();
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(20);
+  EXPECT_TRUE(scheduler.WaitUntil(generation, deadline));
+  EXPECT_GE(Clock::now(), deadline);
+}
+
+TEST(EventScheduler, WakeBeforeTheWaitIsNotLost)
+{
+  EventScheduler scheduler;
+  uint64_t generation = scheduler.Generation();
+  scheduler.Wake();  // e.g. a seek between reading the state and sleeping on it
+  Clock::time_point start = Clock::now();
+  EXPECT_FALSE(scheduler.WaitUntil(generation, start + std::chrono::seconds(10)));
+  EXPECT_LT(Clock::now() - start, std::chrono::seconds(5));
+  scheduler.Wait(generation);  // returns at once as well
+}
+
+TEST(EventScheduler, WakeEndsAWaitInProgress)
+{
+  EventScheduler scheduler;
+  uint64_t generation = scheduler.Generation();
+  std::thread waker([&]{
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    scheduler.Wake();
+  });
+  Clock::time_point start = Clock::now();
+  EXPECT_FALSE(scheduler.WaitUntil(generation, start + std::chrono::seconds(10)));
+  EXPECT_LT(Clock::now() - start, std::chrono::seconds(5));
+  waker.join();
+  EXPECT_NE(generation, scheduler.Generation());
+}
+
+TEST(EventScheduler, NewGenerationWaitsAgain)
+{
+  EventScheduler scheduler;
+  scheduler.Wake();
+  uint64_t generation = scheduler.Generation();
+  EXPECT_TRUE(scheduler.WaitUntil(generation, Clock::now() + std::chrono::milliseconds(5)));
+}
@@ -0,0 +1,210 @@
+#include "file_player/exportcheckpoint.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+class ExportCheckpointTest : public ::testing::Test{
+
+protected:
+  void SetUp() override {
+    char folder[] = "/tmp/exportcheckpoint_testXXXXXX";
+    ASSERT_TRUE(mkdtemp(folder) != NULL);
+    folder_ = folder;
+  }
+
+  void TearDown() override {
+    for(size_t i = 0 ; i < files_.size() ; i ++) unlink(files_[i].c_str());
+    rmdir(folder_.c_str());
+  }
+
+  // <folder>/<name> holding bytes bytes, removed with its checkpoint on tear down
+  std::string WriteFile(const std::string &name, size_t bytes){
+    std::string path = folder_ + "/" + name;
+    FILE *fp = fopen(path.c_str(), "wb");
+    EXPECT_TRUE(fp != NULL);
+    if(fp != NULL){
+      std::vector<char> data(bytes, 1);
+      EXPECT_EQ(bytes, fwrite(data.data(), 1, data.size(), fp));
+      fclose(fp);
+    }
+    Track(path);
+    Track(path + EXPORT_CHECKPOINT_SUFFIX);
+    Track(path + EXPORT_MANIFEST_SUFFIX);
+    return path;
+  }
+
+  void Track(const std::string &path){
+    files_.push_back(path);
+  }
+
+  std::string folder_;
+  std::vector<std::string> files_;
+};
+
+ExportCheckpoint
+MakeCheckpoint(const std::string &key)
+{
+  ExportCheckpoint checkpoint;
+  checkpoint.key = key;
+  checkpoint.first = 1561000000000000000LL;
+  checkpoint.last = 1561000005000000000LL;
+  checkpoint.complete = false;
+  return checkpoint;
+}
+
+ExportSegment
+MakeSegment(uint64_t size, int64_t stamp)
+{
+  ExportSegment segment;
+  segment.size = size;
+  for(int t = 0 ; t < NUM_EXPORT_TOPICS ; t ++) segment.last_stamp[t] = (t == EXPORT_GPS) ? -1 : stamp + t;
+  return segment;
+}
+
+} // namespace
+
+
+TEST(ExportSegmentPath, ContinuesInSplits)
+{
+  EXPECT_EQ("/data/out.bag", ExportSegmentPath("/data/out.bag", 0));
+  EXPECT_EQ("/data/out_001.bag", ExportSegmentPath("/data/out.bag", 1));
+  EXPECT_EQ("/data/out_002_003.bag", ExportSegmentPath("/data/out_002.bag", 3));
+}
+
+TEST_F(ExportCheckpointTest, RoundTrip)
+{
+  std::string bag = WriteFile("a.bag", 4096);
+  WriteFile("a_001.bag", 1000);
+  ExportCheckpoint saved = MakeCheckpoint("0123abcd topics 10100 range 0 9");
+  saved.segments.push_back(MakeSegment(4096, 1561000001000000000LL));
+  saved.segments.push_back(MakeSegment(1000, 1561000002000000000LL));
+  ASSERT_TRUE(SaveExportCheckpoint(bag, saved));
+
+  ExportCheckpoint loaded = MakeCheckpoint("");
+  loaded.complete = true;
+  ASSERT_TRUE(LoadExportCheckpoint(bag, loaded));
+  EXPECT_EQ(saved.key, loaded.key);
+  EXPECT_EQ(saved.first, loaded.first);
+  EXPECT_EQ(saved.last, loaded.last);
+  EXPECT_FALSE(loaded.complete);
+  ASSERT_EQ(2u, loaded.segments.size());
+  for(size_t s = 0 ; s < 2 ; s ++){
+    EXPECT_EQ(saved.segments[s].size, loaded.segments[s].size);
+    for(int t = 0 ; t < NUM_EXPORT_TOPICS ; t ++) EXPECT_EQ(saved.segments[s].last_stamp[t], loaded.segments[s].last_stamp[t]);
+  }
+  EXPECT_TRUE(ExportCheckpointValid(bag, loaded));
+  // the temporary file of the atomic write is gone
+  EXPECT_NE(0, access((bag + EXPORT_CHECKPOINT_SUFFIX ".tmp").c_str(), F_OK));
+
+  RemoveExportCheckpoint(bag);
+  EXPECT_FALSE(LoadExportCheckpoint(bag, loaded));
+  EXPECT_EQ(0, access(bag.c_str(), F_OK));
+}
+
+TEST_F(ExportCheckpointTest, NeedsEverySegment)
+{
+  ExportCheckpoint checkpoint = MakeCheckpoint("key");
+  EXPECT_FALSE(LoadExportCheckpoint(folder_ + "/missing.bag", checkpoint));
+  // nothing closed yet : nothing to check
+  EXPECT_TRUE(ExportCheckpointValid(folder_ + "/missing.bag", checkpoint));
+  checkpoint.segments.push_back(MakeSegment(10, 0));
+  EXPECT_FALSE(ExportCheckpointValid(folder_ + "/missing.bag", checkpoint));
+
+  std::string bag = WriteFile("b.bag", 10);
+  checkpoint.segments.push_back(MakeSegment(20, 0));
+  EXPECT_FALSE(ExportCheckpointValid(bag, checkpoint));
+  WriteFile("b_001.bag", 20);
+  EXPECT_TRUE(ExportCheckpointValid(bag, checkpoint));
+}
+
+TEST_F(ExportCheckpointTest, ChangedSegmentIsNotValid)
+{
+  std::string bag = WriteFile("a.bag", 1000);
+  ExportCheckpoint checkpoint = MakeCheckpoint("key");
+  checkpoint.segments.push_back(MakeSegment(1000, 0));
+  checkpoint.complete = true;
+  ASSERT_TRUE(SaveExportCheckpoint(bag, checkpoint));
+
+  // cut short, or rewritten by an export that was interrupted
+  WriteFile("a.bag", 600);
+  ASSERT_TRUE(LoadExportCheckpoint(bag, checkpoint));
+  EXPECT_FALSE(ExportCheckpointValid(bag, checkpoint));
+  unlink(bag.c_str());
+  EXPECT_FALSE(ExportCheckpointValid(bag, checkpoint));
+}
+
+TEST_F(ExportCheckpointTest, RejectsBrokenFiles)
+{
+  std::string bag = WriteFile("a.bag", 10);
+  const std::string path = bag + EXPORT_CHECKPOINT_SUFFIX;
+  const char *broken[] = {
+    "",
+    "not a checkpoint\nkey k\nrange 1 2\ncomplete 0\n",
+    // the checkpoints of earlier versions
+    "file_player export checkpoint 1\nkey k\nrange 1 2\ncomplete 1\nbag 10 5\n",
+    "file_player export checkpoint 2\nkey k\nrange 1 2\nbag 10\n",
+    "file_player export checkpoint 3\nkey k\nrange 1 2\n",
+    "file_player export checkpoint 3\nkey k\nrange 1\ncomplete 0\n",
+    "file_player export checkpoint 3\nrange 1 2\ncomplete 0\n",
+    "file_player export checkpoint 3\nkey k\nrange 1 2\nsegment 10 1 2 3\ncomplete 0\n",
+    // complete without a segment
+    "file_player export checkpoint 3\nkey k\nrange 1 2\ncomplete 1\n",
+  };
+  for(size_t i = 0 ; i < sizeof(broken) / sizeof(broken[0]) ; i ++){
+    FILE *fp = fopen(path.c_str(), "wb");
+    ASSERT_TRUE(fp != NULL);
+    fputs(broken[i], fp);
+    fclose(fp);
+    ExportCheckpoint checkpoint = MakeCheckpoint("");
+    EXPECT_FALSE(LoadExportCheckpoint(bag, checkpoint)) << "file " << i;
+  }
+}
+
+TEST_F(ExportCheckpointTest, ManifestRoundTrip)
+{
+  const std::string output = folder_ + "/out.bag";
+  Track(output + EXPORT_MANIFEST_SUFFIX);
+  ExportManifest saved;
+  saved.key = "0123abcd split 1000000000 0 1000000000";
+  // paths with spaces are kept whole
+  saved.bags.push_back(std::make_pair(WriteFile("out 000.bag", 300), 300));
+  saved.bags.push_back(std::make_pair(WriteFile("out 001.bag", 200), 200));
+  ASSERT_TRUE(SaveExportManifest(output, saved));
+
+  ExportManifest loaded;
+  ASSERT_TRUE(LoadExportManifest(output, loaded));
+  EXPECT_EQ(saved.key, loaded.key);
+  EXPECT_EQ(saved.bags, loaded.bags);
+  EXPECT_TRUE(ExportManifestValid(loaded));
+
+  RemoveExportManifest(output);
+  EXPECT_FALSE(LoadExportManifest(output, loaded));
+}
+
+TEST_F(ExportCheckpointTest, ManifestNeedsEveryBag)
+{
+  ExportManifest manifest;
+  manifest.key = "key";
+  manifest.bags.push_back(std::make_pair(WriteFile("out_000.bag", 300), 300));
+  manifest.bags.push_back(std::make_pair(WriteFile("out_001.bag", 200), 200));
+  EXPECT_TRUE(ExportManifestValid(manifest));
+
+  WriteFile("out_001.bag", 201);
+  EXPECT_FALSE(ExportManifestValid(manifest));
+  unlink(manifest.bags[1].first.c_str());
+  EXPECT_FALSE(ExportManifestValid(manifest));
+
+  // a manifest without bags is not one
+  const std::string output = folder_ + "/empty.bag";
+  Track(output + EXPORT_MANIFEST_SUFFIX);
+  ExportManifest empty;
+  empty.key = "key";
+  ASSERT_TRUE(SaveExportManifest(output, empty));
+  EXPECT_FALSE(LoadExportManifest(output, empty));
+}
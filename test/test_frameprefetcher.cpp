@@ -0,0 +1,151 @@
+#include "file_player/frameprefetcher.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <gtest/gtest.h>
+
+namespace {
+
+typedef std::vector<size_t> Frame;
+
+// frame i holds i, frames listed in failing can not be loaded
+FramePrefetcher<Frame>::Loader
+MakeLoader(std::vector<size_t> failing = std::vector<size_t>(), int delay_us = 0)
+{
+  return [failing, delay_us](size_t index, Frame &frame){
+    if(delay_us > 0) std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
+    for(size_t f : failing) if(f == index) return false;
+    frame.assign(16, index);
+    return true;
+  };
+}
+
+size_t
+FrameBytes(const Frame &frame)
+{
+  return frame.size() * sizeof(size_t);
+}
+
+} // namespace
+
+
+TEST(FramePrefetcher, HandsOutFramesInOrder)
+{
+  FramePrefetcher<Frame> prefetcher("test");
+  prefetcher.Start(100, MakeLoader(), FrameBytes, 8, 1 << 20, 2);
+  for(size_t i = 0 ; i < 100 ; i ++){
+    Frame frame;
+    ASSERT_TRUE(prefetcher.Get(i, frame));
+    ASSERT_EQ(16u, frame.size());
+    EXPECT_EQ(i, frame[0]);
+  }
+  EXPECT_EQ(100u, prefetcher.hits() + prefetcher.misses());
+  prefetcher.Stop();
+}
+
+TEST(FramePrefetcher, FailedFramesAreMisses)
+{
+  std::vector<size_t> failing;
+  for(size_t i = 5 ; i < 100 ; i += 10) failing.push_back(i);
+  FramePrefetcher<Frame> prefetcher("test");
+  prefetcher.Start(100, MakeLoader(failing, 200), FrameBytes, 4, 1 << 20, 2);
+  size_t failed = 0;
+  for(size_t i = 0 ; i < 100 ; i ++){
+    Frame frame;
+    if(!prefetcher.Get(i, frame)) failed++;
+    else{
+      EXPECT_EQ(i, frame[0]);
+    }
+  }
+  EXPECT_EQ(failing.size(), failed);
+  EXPECT_GE(prefetcher.misses(), failing.size());
+  EXPECT_EQ(100u, prefetcher.hits() + prefetcher.misses());
+  prefetcher.Stop();
+}
+
+TEST(FramePrefetcher, WithoutDepthLoadsSynchronously)
+{
+  FramePrefetcher<Frame> prefetcher("test");
+  prefetcher.Start(10, MakeLoader(), FrameBytes, 0, 1 << 20, 2);
+  Frame frame;
+  EXPECT_TRUE(prefetcher.Get(3, frame));
+  EXPECT_EQ(3u, frame[0]);
+  EXPECT_EQ(0u, prefetcher.hits());
+  EXPECT_EQ(1u, prefetcher.misses());
+}
+
+// A Get() waiting on a slot that is still loading while seeks move the window away from it :
+// the slot must stay valid until the waiter took its frame.
+TEST(FramePrefetcher, SeekWhileGetWaits)
+{
+  for(int round = 0 ; round < 20 ; round ++){
+    FramePrefetcher<Frame> prefetcher("test");
+    prefetcher.Start(1000, MakeLoader(std::vector<size_t>(), 500), FrameBytes, 8, 1 << 20, 3);
+    std::atomic<bool> done(false);
+    std::thread seeker([&]{
+      size_t target = 500;
+      while(!done){
+        prefetcher.Seek(target);
+        target = (target + 37) % 1000;
+        std::this_thread::yield();
+      }
+    });
+    for(size_t i = 0 ; i < 50 ; i ++){
+      Frame frame;
+      if(prefetcher.Get(i, frame)){
+        EXPECT_EQ(i, frame[0]);
+      }
+    }
+    done = true;
+    seeker.join();
+    prefetcher.Stop();
+  }
+}
+
+TEST(FramePrefetcher, StopWhileLoading)
+{
+  FramePrefetcher<Frame> prefetcher("test");
+  prefetcher.Start(100, MakeLoader(std::vector<size_t>(), 1000), FrameBytes, 16, 1 << 20, 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  prefetcher.Stop();
+  prefetcher.Start(100, MakeLoader(), FrameBytes, 16, 1 << 20, 4);
+  Frame frame;
+  EXPECT_TRUE(prefetcher.Get(0, frame));
+  EXPECT_EQ(0u, frame[0]);
+}
+
+TEST(FramePrefetcher, RecyclesBoundedFrames)
+{
+  // a consumer slower than the loaders, so every Get() finds its frame ready
+  FramePrefetcher<Frame> prefetcher("test");
+  prefetcher.Start(2000, MakeLoader(), FrameBytes, 4, 1 << 20, 2);
+  for(size_t i = 0 ; i < 2000 ; i ++){
+    Frame frame;
+    ASSERT_TRUE(prefetcher.Get(i, frame));
+    EXPECT_EQ(i, frame[0]);
+    ASSERT_LE(prefetcher.free_frames(), 4u) << "after frame " << i;
+    if(i % 100 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  prefetcher.Stop();
+}
+
+TEST(FramePrefetcher, LoadersReuseFrameBuffers)
+{
+  std::atomic<size_t> allocations(0);
+  FramePrefetcher<Frame> prefetcher("test");
+  prefetcher.Start(500, [&](size_t index, Frame &frame){
+                     if(frame.capacity() < 16) allocations++;
+                     frame.assign(16, index);
+                     return true;
+                   }, FrameBytes, 4, 1 << 20, 1);
+  for(size_t i = 0 ; i < 500 ; i ++){
+    Frame frame(16);  // every Get() hands an allocated buffer back
+    ASSERT_TRUE(prefetcher.Get(i, frame));
+    EXPECT_EQ(i, frame[0]);
+  }
+  prefetcher.Stop();
+  // only the first frames of the window (and the synchronous misses) allocate
+  EXPECT_LT(allocations.load(), 50u);
+}
@@ -0,0 +1,95 @@
+#include "file_player/latencystats.h"
+
+#include <thread>
+#include <algorithm>
+#include <vector>
+#include <gtest/gtest.h>
+
+
+TEST(LatencyHistogram, EmptyInterval)
+{
+  LatencyHistogram histogram;
+  HistogramSummary summary = histogram.TakeInterval();
+  EXPECT_EQ(0u, summary.count);
+  EXPECT_EQ(0.0, summary.mean);
+  EXPECT_EQ(0, summary.p50);
+  EXPECT_EQ(0, summary.p99);
+  EXPECT_EQ(0, summary.max);
+}
+
+TEST(LatencyHistogram, PercentilesAreBucketUpperBounds)
+{
+  LatencyHistogram histogram;
+  for(int64_t v = 1 ; v <= 100 ; v ++) histogram.Record(v);
+  EXPECT_EQ(100u, histogram.count());
+  HistogramSummary summary = histogram.TakeInterval();
+  EXPECT_EQ(100u, summary.count);
+  EXPECT_DOUBLE_EQ(50.5, summary.mean);
+  EXPECT_EQ(100, summary.max);
+  EXPECT_EQ(63, summary.p50);   // 50 is in [32, 64)
+  EXPECT_EQ(100, summary.p99);  // 99 is in [64, 128), capped at the max
+}
+
+TEST(LatencyHistogram, PercentilesWithinAFactorOfTwo)
+{
+  LatencyHistogram histogram;
+  std::vector<int64_t> values;
+  uint64_t x = 88172645463325252ULL;
+  for(int i = 0 ; i < 10001 ; i ++){
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    values.push_back(static_cast<int64_t>(x % 50000000));
+    histogram.Record(values.back());
+  }
+  std::sort(values.begin(), values.end());
+  HistogramSummary summary = histogram.TakeInterval();
+  int64_t p50 = values[5000], p99 = values[9900];
+  EXPECT_GE(summary.p50, p50);
+  EXPECT_LE(summary.p50, 2 * p50 + 1);
+  EXPECT_GE(summary.p99, p99);
+  EXPECT_LE(summary.p99, 2 * p99 + 1);
+  EXPECT_EQ(values.back(), summary.max);
+}
+
+TEST(LatencyHistogram, ZeroAndNegativeSamples)
+{
+  LatencyHistogram histogram;
+  histogram.Record(0);
+  histogram.Record(-5);  // e.g. an event published ahead of its due time
+  histogram.Record(0);
+  HistogramSummary summary = histogram.TakeInterval();
+  EXPECT_EQ(3u, summary.count);
+  EXPECT_EQ(0, summary.p50);
+  EXPECT_EQ(0, summary.p99);
+  EXPECT_EQ(0, summary.max);
+}
+
+TEST(LatencyHistogram, TakeIntervalStartsANewInterval)
+{
+  LatencyHistogram histogram;
+  histogram.Record(1000);
+  histogram.TakeInterval();
+  EXPECT_EQ(0u, histogram.count());
+  histogram.Record(3);
+  HistogramSummary summary = histogram.TakeInterval();
+  EXPECT_EQ(1u, summary.count);
+  EXPECT_EQ(3, summary.max);
+  EXPECT_EQ(3, summary.p50);
+}
+
+TEST(LatencyHistogram, ConcurrentRecords)
+{
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for(int t = 0 ; t < 4 ; t ++){
+    threads.push_back(std::thread([&histogram, t]{
+      for(int i = 0 ; i < 10000 ; i ++) histogram.Record(t * 10000 + i);
+    }));
+  }
+  for(auto &th : threads) th.join();
+  HistogramSummary summary = histogram.TakeInterval();
+  EXPECT_EQ(40000u, summary.count);
+  EXPECT_EQ(39999, summary.max);
+  EXPECT_DOUBLE_EQ(19999.5, summary.mean);
+}
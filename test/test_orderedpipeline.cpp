@@ -0,0 +1,80 @@
+#include "file_player/orderedpipeline.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <gtest/gtest.h>
+
+namespace {
+
+typedef std::vector<char> Item;
+
+const size_t kItemBytes = 1000;
+
+size_t
+ItemBytes(const Item &item)
+{
+  return item.size();
+}
+
+} // namespace
+
+
+TEST(OrderedPipeline, HandsOutItemsInOrder)
+{
+  OrderedPipeline<Item> pipeline(
+    200,
+    [](size_t index, Item &item){
+      if(index % 10 == 5) return false;
+      item.assign(kItemBytes, static_cast<char>(index));
+      return true;
+    },
+    ItemBytes, 8, 1 << 20, 16);
+
+  size_t index, count = 0, failed = 0;
+  Item item;
+  bool ok;
+  while(pipeline.Next(index, item, ok)){
+    EXPECT_EQ(count, index);
+    if(!ok) failed++;
+    else{
+      EXPECT_EQ(static_cast<char>(index), item[0]);
+    }
+    count++;
+  }
+  EXPECT_EQ(200u, count);
+  EXPECT_EQ(20u, failed);
+}
+
+TEST(OrderedPipeline, ByteCapCountsItemsInProduction)
+{
+  // 8 workers, room for 3 items : once the size of an item is known, items still being
+  // produced count against the cap as well, not only the finished ones waiting in the buffer
+  std::atomic<size_t> started(0), consumed(0), peak(0);
+  OrderedPipeline<Item> pipeline(
+    200,
+    [&](size_t index, Item &item){
+      size_t live = ++started - consumed;
+      if(index >= 16){
+        size_t seen = peak;
+        while(live > seen && !peak.compare_exchange_weak(seen, live)){}
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(500));
+      item.assign(kItemBytes, 1);
+      return true;
+    },
+    ItemBytes, 8, 3 * kItemBytes, 100);
+
+  size_t index;
+  Item item;
+  bool ok;
+  while(pipeline.Next(index, item, ok)){
+    ASSERT_TRUE(ok);
+    consumed++;
+  }
+  EXPECT_EQ(200u, consumed);
+  // 3 items within the cap, plus one the consumer has taken but not counted yet
+  EXPECT_LE(peak, 4u);
+}
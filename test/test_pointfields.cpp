@@ -0,0 +1,92 @@
+#include "file_player/pointfields.h"
+
+#include <string.h>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+const char *kKernelNames[NUM_POINT_FIELDS_KERNELS] = {"scalar", "sse2", "avx2"};
+
+// random .bin bytes, any bit pattern (NaNs included) must be copied as it is
+std::vector<uint8_t>
+MakeBin(size_t num_points, uint64_t seed)
+{
+  std::vector<uint8_t> bin(num_points * OUSTER_BIN_POINT_SIZE);
+  uint64_t x = seed * 2654435761ULL + 1;
+  for(size_t i = 0 ; i < bin.size() ; i ++){
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    bin[i] = static_cast<uint8_t>(x);
+  }
+  return bin;
+}
+
+// num_points points plus one guard point after them, all filled with garbage first
+std::vector<OusterPoint>
+WritePoints(PointFieldsKernel kernel, const std::vector<uint8_t> &bin, size_t num_points, uint32_t scan_period_ns)
+{
+  std::vector<OusterPoint> points(num_points + 1);
+  memset(points.data(), 0xa5, points.size() * sizeof(OusterPoint));
+  WriteOusterPointsWith(kernel, bin.data(), points.data(), num_points, scan_period_ns);
+  return points;
+}
+
+} // namespace
+
+
+TEST(PointFields, ScalarFields)
+{
+  // two full columns and a partial one of 3 points
+  const size_t n = 2 * OUSTER_CHANNELS + 3;
+  std::vector<uint8_t> bin = MakeBin(n, 1);
+  std::vector<OusterPoint> points = WritePoints(POINT_FIELDS_SCALAR, bin, n, 100000000);
+  for(size_t k = 0 ; k < n ; k ++){
+    EXPECT_EQ(0, memcmp(&points[k].x, &bin[k * OUSTER_BIN_POINT_SIZE], OUSTER_BIN_POINT_SIZE));
+    EXPECT_EQ(static_cast<int32_t>(k % OUSTER_CHANNELS) + 1, points[k].ring);
+  }
+  EXPECT_EQ(0u, points[0].t);
+  EXPECT_EQ(0u, points[OUSTER_CHANNELS - 1].t);
+  EXPECT_EQ(50000000u, points[OUSTER_CHANNELS].t);
+  EXPECT_EQ(100000000u, points[2 * OUSTER_CHANNELS].t);  // partial column : the column after the last full one
+}
+
+// every kernel this CPU has writes the scalar output bit for bit, over full scans, odd point
+// counts, partial trailing columns and extreme scan periods
+TEST(PointFields, KernelsMatchScalar)
+{
+  const size_t counts[] = {0, 1, 2, 3, 31, 63, 64, 65, 66, 127, 128, 129, 190, 191, 64 * 17 + 5,
+                           64 * 1024 - 1, 64 * 1024, 64 * 1024 + 1, 64 * 1024 + 63};
+  const uint32_t periods[] = {100000000, 0, 1, 99999999, 0xffffffffu};
+  int kernels_run = 0;
+  for(int kernel = POINT_FIELDS_SSE2 ; kernel < NUM_POINT_FIELDS_KERNELS ; kernel ++){
+    if(!PointFieldsKernelSupported(static_cast<PointFieldsKernel>(kernel))) continue;
+    kernels_run++;
+    for(size_t n : counts){
+      std::vector<uint8_t> bin = MakeBin(n, n);
+      for(uint32_t period : periods){
+        std::vector<OusterPoint> expected = WritePoints(POINT_FIELDS_SCALAR, bin, n, period);
+        std::vector<OusterPoint> actual = WritePoints(static_cast<PointFieldsKernel>(kernel), bin, n, period);
+        ASSERT_EQ(0, memcmp(expected.data(), actual.data(), expected.size() * sizeof(OusterPoint)))
+          << kKernelNames[kernel] << ", " << n << " points, period " << period;
+      }
+    }
+  }
+#if defined(__x86_64__) || defined(__i386__)
+  EXPECT_GE(kernels_run, 1);  // SSE2 is always there
+#endif
+}
+
+TEST(PointFields, DispatchUsesTheBestKernel)
+{
+  EXPECT_TRUE(PointFieldsKernelSupported(BestPointFieldsKernel()));
+  EXPECT_TRUE(PointFieldsKernelSupported(POINT_FIELDS_SCALAR));
+  const size_t n = 64 * 100 + 7;
+  std::vector<uint8_t> bin = MakeBin(n, 9);
+  std::vector<OusterPoint> expected = WritePoints(POINT_FIELDS_SCALAR, bin, n, 100000000);
+  std::vector<OusterPoint> actual(n + 1);
+  memset(actual.data(), 0xa5, actual.size() * sizeof(OusterPoint));
+  WriteOusterPoints(bin.data(), actual.data(), n, 100000000);
+  EXPECT_EQ(0, memcmp(expected.data(), actual.data(), actual.size() * sizeof(OusterPoint)));
+}
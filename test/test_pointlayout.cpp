@@ -0,0 +1,149 @@
+#include "file_player/pointlayout.h"
+
+#include <cmath>
+#include <string.h>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+sensor_msgs::PointCloud2
+MakeCloud()
+{
+  std::vector<OusterPoint> points;
+  for(int k = 0 ; k < 64 * 3 + 5 ; k ++){
+    OusterPoint p;
+    p.x = 0.37f * k - 30.0f;
+    p.y = -0.11f * k + 5.0f;
+    p.z = 0.013f * k - 1.0f;
+    p.intensity = static_cast<float>(k * 7 % 900);
+    p.t = static_cast<uint32_t>(k / 64) * 33333333u;
+    p.ring = k % 64 + 1;
+    points.push_back(p);
+  }
+  sensor_msgs::PointCloud2 cloud;
+  InitOusterCloud(cloud, points.size());
+  memcpy(cloud.data.data(), points.data(), points.size() * sizeof(OusterPoint));
+  cloud.header.frame_id = "os1_lidar";
+  return cloud;
+}
+
+const OusterPoint *
+PointsOf(const sensor_msgs::PointCloud2 &cloud)
+{
+  return reinterpret_cast<const OusterPoint *>(cloud.data.data());
+}
+
+} // namespace
+
+
+TEST(PointLayout, Parse)
+{
+  PointLayout layout;
+  EXPECT_TRUE(ParsePointLayout("xyz16", layout));
+  EXPECT_EQ(POINT_LAYOUT_XYZ16, layout);
+  EXPECT_TRUE(ParsePointLayout("full", layout));
+  EXPECT_EQ(POINT_LAYOUT_FULL, layout);
+  EXPECT_FALSE(ParsePointLayout("xyz8", layout));
+  EXPECT_EQ(8u, PointLayoutStep(POINT_LAYOUT_XYZ16));
+  EXPECT_EQ(22u, PointLayoutStep(POINT_LAYOUT_XYZIRT));
+}
+
+// the scale rides in the "xyz_scale=<scale>" field and decodes back within half a step
+TEST(PointLayout, Xyz16RoundTrip)
+{
+  sensor_msgs::PointCloud2 in = MakeCloud(), encoded, decoded;
+  const float scales[] = {0.01f, 0.002f, 0.0123456789f};
+  for(float scale : scales){
+    EncodeOusterCloud(in, encoded, POINT_LAYOUT_XYZ16, scale);
+    EXPECT_EQ(8u, encoded.point_step);
+    EXPECT_EQ(in.data.size() / sizeof(OusterPoint) * 8, encoded.data.size());
+    ASSERT_FALSE(encoded.fields.empty());
+    EXPECT_EQ(0, encoded.fields.back().name.compare(0, strlen(POINT_LAYOUT_SCALE_FIELD), POINT_LAYOUT_SCALE_FIELD));
+    EXPECT_EQ(0u, encoded.fields.back().count);
+
+    PointLayout layout;
+    float read_scale;
+    ASSERT_TRUE(PointLayoutOf(encoded, layout, read_scale));
+    EXPECT_EQ(POINT_LAYOUT_XYZ16, layout);
+    EXPECT_NEAR(scale, read_scale, scale * 1e-5f);
+
+    ASSERT_TRUE(DecodeOusterCloud(encoded, decoded));
+    EXPECT_EQ(in.header.frame_id, decoded.header.frame_id);
+    ASSERT_EQ(in.data.size(), decoded.data.size());
+    const OusterPoint *a = PointsOf(in), *b = PointsOf(decoded);
+    for(size_t k = 0 ; k < in.data.size() / sizeof(OusterPoint) ; k ++){
+      float tolerance = read_scale * 0.5f * 1.001f;
+      if(std::fabs(a[k].x) < 32767 * read_scale){
+        EXPECT_NEAR(a[k].x, b[k].x, tolerance) << k;
+      }
+      EXPECT_NEAR(a[k].y, b[k].y, tolerance) << k;
+      EXPECT_NEAR(a[k].z, b[k].z, tolerance) << k;
+      EXPECT_NEAR(std::floor(a[k].intensity + 0.5f), b[k].intensity, 0.0f) << k;
+    }
+  }
+}
+
+// out of range coordinates clamp to +-32767 steps, NaN lands on the low bound
+TEST(PointLayout, Xyz16Clamps)
+{
+  sensor_msgs::PointCloud2 in, encoded, decoded;
+  InitOusterCloud(in, 3);
+  OusterPoint *p = reinterpret_cast<OusterPoint *>(in.data.data());
+  OusterPoint points[3] = {{1000.0f, -1000.0f, NAN, -5.0f, 0, 1}, {0.0f, 0.0f, 0.0f, 70000.0f, 0, 2}, {0.004f, -0.006f, 0.0f, 1.0f, 0, 3}};
+  memcpy(p, points, sizeof(points));
+  EncodeOusterCloud(in, encoded, POINT_LAYOUT_XYZ16, 0.01f);
+  ASSERT_TRUE(DecodeOusterCloud(encoded, decoded));
+  const OusterPoint *d = PointsOf(decoded);
+  EXPECT_FLOAT_EQ(327.67f, d[0].x);
+  EXPECT_FLOAT_EQ(-327.67f, d[0].y);
+  EXPECT_FLOAT_EQ(-327.67f, d[0].z);
+  EXPECT_EQ(0.0f, d[0].intensity);
+  EXPECT_EQ(65535.0f, d[1].intensity);
+  EXPECT_FLOAT_EQ(0.0f, d[2].x);   // rounds to the nearest step
+  EXPECT_FLOAT_EQ(-0.01f, d[2].y);
+}
+
+TEST(PointLayout, XyziAndXyzirtRoundTrip)
+{
+  sensor_msgs::PointCloud2 in = MakeCloud(), encoded, decoded;
+  const OusterPoint *a = PointsOf(in);
+  size_t n = in.data.size() / sizeof(OusterPoint);
+
+  EncodeOusterCloud(in, encoded, POINT_LAYOUT_XYZI, 0.0f);
+  ASSERT_TRUE(DecodeOusterCloud(encoded, decoded));
+  const OusterPoint *b = PointsOf(decoded);
+  for(size_t k = 0 ; k < n ; k ++){
+    EXPECT_EQ(0, memcmp(&a[k].x, &b[k].x, 16));
+    EXPECT_EQ(0u, b[k].t);
+  }
+
+  EncodeOusterCloud(in, encoded, POINT_LAYOUT_XYZIRT, 0.0f);
+  ASSERT_TRUE(DecodeOusterCloud(encoded, decoded));
+  b = PointsOf(decoded);
+  for(size_t k = 0 ; k < n ; k ++){
+    EXPECT_EQ(0, memcmp(&a[k].x, &b[k].x, 16));
+    EXPECT_EQ(a[k].ring, b[k].ring);
+    EXPECT_NEAR(static_cast<double>(a[k].t), static_cast<double>(b[k].t), 8.0);  // float seconds
+  }
+
+  EncodeOusterCloud(in, encoded, POINT_LAYOUT_FULL, 0.0f);
+  PointLayout layout;
+  float scale;
+  ASSERT_TRUE(PointLayoutOf(encoded, layout, scale));
+  EXPECT_EQ(POINT_LAYOUT_FULL, layout);
+  ASSERT_TRUE(DecodeOusterCloud(encoded, decoded));
+  EXPECT_EQ(in.data, decoded.data);
+}
+
+TEST(PointLayout, UnknownLayouts)
+{
+  sensor_msgs::PointCloud2 encoded, decoded;
+  EncodeOusterCloud(MakeCloud(), encoded, POINT_LAYOUT_XYZ16, 0.01f);
+  encoded.fields.back().name = POINT_LAYOUT_SCALE_FIELD "abc";
+  PointLayout layout;
+  float scale;
+  EXPECT_FALSE(PointLayoutOf(encoded, layout, scale));
+  encoded.fields.pop_back();  // no scale : not xyz16
+  EXPECT_FALSE(DecodeOusterCloud(encoded, decoded));
+}
@@ -0,0 +1,160 @@
+#include "file_player/radardecoder.h"
+#include "file_player/frameprefetcher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <opencv2/highgui/highgui.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+// radar/polar like scans : 400 range bins by 40 azimuths, pixel (r, c) = seed + r + 3*c
+cv::Mat
+MakeScan(int seed)
+{
+  cv::Mat image(40, 400, CV_8UC1);
+  for(int r = 0 ; r < image.rows ; r ++){
+    uint8_t *row = image.ptr<uint8_t>(r);
+    for(int c = 0 ; c < image.cols ; c ++) row[c] = static_cast<uint8_t>(seed + r + 3*c);
+  }
+  return image;
+}
+
+bool
+SameImage(const cv::Mat &a, const cv::Mat &b)
+{
+  if(a.rows != b.rows || a.cols != b.cols || a.type() != b.type()) return false;
+  for(int r = 0 ; r < a.rows ; r ++)
+    if(memcmp(a.ptr<uint8_t>(r), b.ptr<uint8_t>(r), a.cols) != 0) return false;
+  return true;
+}
+
+class RadarDecoderTest : public ::testing::Test{
+
+protected:
+  void SetUp() override {
+    char folder[] = "/tmp/radardecoder_testXXXXXX";
+    ASSERT_TRUE(mkdtemp(folder) != NULL);
+    folder_ = folder;
+  }
+
+  void TearDown() override {
+    for(size_t i = 0 ; i < files_.size() ; i ++) unlink(files_[i].c_str());
+    rmdir(folder_.c_str());
+  }
+
+  // write scan as <folder>/<name>.png and return its path and bytes
+  std::string WritePng(const std::string &name, const cv::Mat &scan, std::vector<uint8_t> &bytes){
+    std::string path = folder_ + "/" + name + ".png";
+    EXPECT_TRUE(cv::imencode(".png", scan, bytes));
+    FILE *fp = fopen(path.c_str(), "wb");
+    EXPECT_TRUE(fp != NULL);
+    if(fp != NULL){
+      EXPECT_EQ(bytes.size(), fwrite(bytes.data(), 1, bytes.size(), fp));
+      fclose(fp);
+    }
+    files_.push_back(path);
+    return path;
+  }
+
+  std::string folder_;
+  std::vector<std::string> files_;
+};
+
+} // namespace
+
+
+TEST_F(RadarDecoderTest, DecodesThePolarPng)
+{
+  std::vector<uint8_t> bytes;
+  cv::Mat scan = MakeScan(7);
+  std::string path = WritePng("1561000000000000000", scan, bytes);
+
+  RadarPolarFrame frame;
+  ASSERT_TRUE(LoadRadarPolar(path, frame, true));
+  EXPECT_EQ(bytes, frame.png);
+  EXPECT_TRUE(SameImage(scan, frame.image));
+
+  // loading again reuses the buffers of the frame
+  cv::Mat other = MakeScan(100);
+  path = WritePng("1561000000250000000", other, bytes);
+  ASSERT_TRUE(LoadRadarPolar(path, frame, true));
+  EXPECT_TRUE(SameImage(other, frame.image));
+}
+
+TEST_F(RadarDecoderTest, MissingOrBrokenFiles)
+{
+  RadarPolarFrame frame;
+  EXPECT_FALSE(LoadRadarPolar(folder_ + "/none.png", frame, true));
+  EXPECT_FALSE(LoadRadarPolar(folder_ + "/none.png", frame, false));
+
+  std::vector<uint8_t> bytes(64, 0x5a);
+  std::string path = folder_ + "/broken.png";
+  FILE *fp = fopen(path.c_str(), "wb");
+  ASSERT_TRUE(fp != NULL);
+  fwrite(bytes.data(), 1, bytes.size(), fp);
+  fclose(fp);
+  files_.push_back(path);
+  EXPECT_FALSE(LoadRadarPolar(path, frame, true));
+}
+
+// the read-ahead pool hands every scan back decoded from its own file
+TEST_F(RadarDecoderTest, ReadAheadDecodesTheRightFiles)
+{
+  const size_t count = 24;
+  std::vector<std::string> paths;
+  std::vector<uint8_t> bytes;
+  for(size_t i = 0 ; i < count ; i ++)
+    paths.push_back(WritePng(std::to_string(1561000000000000000LL + 250000000LL * i), MakeScan(static_cast<int>(i)), bytes));
+
+  FramePrefetcher<RadarPolarFrame> prefetcher("radar test");
+  prefetcher.Start(count,
+                   [&](size_t index, RadarPolarFrame &frame){ return LoadRadarPolar(paths[index], frame, true); },
+                   [](const RadarPolarFrame &frame){ return frame.png.size() + frame.image.total() * frame.image.elemSize(); },
+                   4, 1 << 20, 2);
+  for(size_t i = 0 ; i < count ; i ++){
+    RadarPolarFrame frame;
+    ASSERT_TRUE(prefetcher.Get(i, frame));
+    EXPECT_TRUE(SameImage(MakeScan(static_cast<int>(i)), frame.image)) << "scan " << i;
+  }
+  prefetcher.Stop();
+}
+
+// compressed output : the file bytes go out untouched and nothing is decoded
+TEST_F(RadarDecoderTest, PassesThePngThroughWithoutDecoding)
+{
+  std::vector<uint8_t> bytes;
+  cv::Mat scan = MakeScan(42);
+  std::string path = WritePng("1561000000500000000", scan, bytes);
+
+  RadarPolarFrame frame;
+  ASSERT_TRUE(LoadRadarPolar(path, frame, false));
+  EXPECT_EQ(bytes, frame.png);
+  EXPECT_TRUE(frame.image.empty());
+
+  // what a subscriber of /radar/polar/compressed decodes is the scan on disk
+  cv::Mat encoded(1, static_cast<int>(frame.png.size()), CV_8UC1, frame.png.data());
+  cv::Mat decoded;
+  cv::imdecode(encoded, cv::IMREAD_GRAYSCALE, &decoded);
+  EXPECT_TRUE(SameImage(scan, decoded));
+}
+
+TEST(ReadFileBytes, KeepsTheBufferCapacity)
+{
+  std::vector<uint8_t> bytes;
+  bytes.reserve(1 << 16);
+  const uint8_t *data = bytes.data();
+  char path[] = "/tmp/readfilebytes_testXXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(5, write(fd, "hello", 5));
+  close(fd);
+  EXPECT_TRUE(ReadFileBytes(path, bytes));
+  EXPECT_EQ(std::vector<uint8_t>({'h', 'e', 'l', 'l', 'o'}), bytes);
+  EXPECT_EQ(data, bytes.data());
+  unlink(path);
+}
@@ -0,0 +1,115 @@
+#include "file_player/sequence.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+namespace {
+
+const int64_t kStart = 1561000000000000000LL;
+const int64_t kMs = 1000000LL;
+
+// sensor_data with radar events every 250 ms and a radar/polar image for each of them
+class SequenceTest : public ::testing::Test{
+
+protected:
+  void SetUp() override {
+    char folder[] = "/tmp/sequence_testXXXXXX";
+    ASSERT_TRUE(mkdtemp(folder) != NULL);
+    folder_ = folder;
+    dirs_.push_back(folder_);
+    MakeDir("/sensor_data");
+    MakeDir("/sensor_data/radar");
+    MakeDir("/sensor_data/radar/polar");
+
+    std::string stamps;
+    for(int k = 0 ; k < 8 ; k ++){
+      int64_t stamp = kStart + k * 250 * kMs;
+      stamps += std::to_string(stamp) + ",radar\n";
+      WriteFile("/sensor_data/radar/polar/" + std::to_string(stamp) + ".png", "png");
+      radar_stamps_.push_back(stamp);
+    }
+    WriteFile("/sensor_data/data_stamp.csv", stamps);
+    sequence_.use_cache_ = false;
+  }
+
+  void TearDown() override {
+    for(size_t i = 0 ; i < files_.size() ; i ++) unlink(files_[i].c_str());
+    for(size_t i = dirs_.size() ; i -- > 0 ; ) rmdir(dirs_[i].c_str());
+  }
+
+  void MakeDir(const std::string &name){
+    ASSERT_EQ(0, mkdir((folder_ + name).c_str(), 0755));
+    dirs_.push_back(folder_ + name);
+  }
+
+  void WriteFile(const std::string &name, const std::string &data){
+    FILE *fp = fopen((folder_ + name).c_str(), "wb");
+    ASSERT_TRUE(fp != NULL);
+    fputs(data.c_str(), fp);
+    fclose(fp);
+    files_.push_back(folder_ + name);
+  }
+
+  // radar event rows, in stamp order
+  std::vector<int32_t> RadarRows(){
+    std::vector<int32_t> rows;
+    for(size_t i = 0 ; i < sequence_.data_stamp_.size() ; i ++)
+      if(sequence_.data_stamp_[i].sensor == SENSOR_RADAR) rows.push_back(sequence_.data_stamp_[i].index);
+    return rows;
+  }
+
+  std::string folder_;
+  std::vector<std::string> dirs_;
+  std::vector<std::string> files_;
+  std::vector<int64_t> radar_stamps_;
+  MulranSequence sequence_;
+};
+
+} // namespace
+
+
+TEST_F(SequenceTest, RadarEventsResolveToPolar)
+{
+  ASSERT_TRUE(sequence_.Load(folder_, false));
+  ASSERT_EQ(radar_stamps_.size(), sequence_.radarpolar_file_stamps_.size());
+  std::vector<int32_t> rows = RadarRows();
+  ASSERT_EQ(radar_stamps_.size(), rows.size());
+  for(size_t k = 0 ; k < rows.size() ; k ++) EXPECT_EQ(static_cast<int32_t>(k), rows[k]);
+}
+
+TEST_F(SequenceTest, MissingRayFolderKeepsPolar)
+{
+  ASSERT_TRUE(sequence_.Load(folder_, false));
+  std::vector<int32_t> polar_rows = RadarRows();
+
+  EXPECT_FALSE(sequence_.UseRadarRay());
+  EXPECT_TRUE(sequence_.radarray_file_stamps_.empty());
+  EXPECT_EQ(polar_rows, RadarRows());
+
+  // an empty radar/ray folder is the same
+  MakeDir("/sensor_data/radar/ray");
+  EXPECT_FALSE(sequence_.UseRadarRay());
+  EXPECT_EQ(polar_rows, RadarRows());
+}
+
+TEST_F(SequenceTest, RayFilesReplacePolar)
+{
+  ASSERT_TRUE(sequence_.Load(folder_, false));
+  // ray files for every other scan only
+  MakeDir("/sensor_data/radar/ray");
+  for(size_t k = 0 ; k < radar_stamps_.size() ; k += 2)
+    WriteFile("/sensor_data/radar/ray/" + std::to_string(radar_stamps_[k]) + ".csv", "0\n");
+
+  ASSERT_TRUE(sequence_.UseRadarRay());
+  EXPECT_EQ(radar_stamps_.size() / 2, sequence_.radarray_file_stamps_.size());
+  std::vector<int32_t> rows = RadarRows();
+  ASSERT_EQ(radar_stamps_.size(), rows.size());
+  for(size_t k = 0 ; k < rows.size() ; k ++) EXPECT_EQ(k % 2 == 0 ? static_cast<int32_t>(k / 2) : -1, rows[k]) << "scan " << k;
+  EXPECT_EQ(sequence_.RadarrayPath(radar_stamps_[2]),
+            folder_ + "/sensor_data/radar/ray/" + std::to_string(radar_stamps_[2]) + ".csv");
+}
@@ -0,0 +1,70 @@
+#include "file_player/timeline.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+Timeline
+MakeTimeline()
+{
+  // stamps 10 20 20 20 30, added out of order
+  Timeline timeline;
+  timeline.Add(30, SENSOR_RADAR);
+  timeline.Add(20, SENSOR_IMU);
+  timeline.Add(10, SENSOR_GPS);
+  timeline.Add(20, SENSOR_OUSTER);
+  timeline.Add(20, SENSOR_GPS);
+  timeline.Sort();
+  return timeline;
+}
+
+} // namespace
+
+
+TEST(Timeline, LowerBoundOfEmptyTimelineIsZero)
+{
+  Timeline timeline;
+  EXPECT_EQ(0u, timeline.LowerBound(0));
+  EXPECT_EQ(0u, timeline.Find(0));
+}
+
+TEST(Timeline, LowerBound)
+{
+  Timeline timeline = MakeTimeline();
+  ASSERT_EQ(5u, timeline.size());
+  EXPECT_EQ(0u, timeline.LowerBound(-1));
+  EXPECT_EQ(0u, timeline.LowerBound(10));
+  EXPECT_EQ(1u, timeline.LowerBound(11));
+  EXPECT_EQ(1u, timeline.LowerBound(20));   // first of the equal stamps
+  EXPECT_EQ(4u, timeline.LowerBound(21));
+  EXPECT_EQ(4u, timeline.LowerBound(30));
+  EXPECT_EQ(5u, timeline.LowerBound(31));   // past the end
+}
+
+TEST(Timeline, FindOnlyMatchesExactStamps)
+{
+  Timeline timeline = MakeTimeline();
+  EXPECT_EQ(1u, timeline.Find(20));
+  EXPECT_EQ(4u, timeline.Find(30));
+  EXPECT_EQ(timeline.size(), timeline.Find(15));
+  EXPECT_EQ(timeline.size(), timeline.Find(40));
+}
+
+TEST(Timeline, SortKeepsTheOrderOfEqualStamps)
+{
+  Timeline timeline = MakeTimeline();
+  EXPECT_EQ(SENSOR_GPS, timeline[0].sensor);
+  EXPECT_EQ(SENSOR_IMU, timeline[1].sensor);
+  EXPECT_EQ(SENSOR_OUSTER, timeline[2].sensor);
+  EXPECT_EQ(SENSOR_GPS, timeline[3].sensor);
+  EXPECT_EQ(SENSOR_RADAR, timeline[4].sensor);
+  EXPECT_EQ(-1, timeline[0].index);
+}
+
+TEST(Timeline, SensorIdFromName)
+{
+  EXPECT_EQ(SENSOR_IMU, SensorIdFromName("imu"));
+  EXPECT_EQ(SENSOR_RADAR, SensorIdFromName("radar"));
+  EXPECT_EQ(SENSOR_UNKNOWN, SensorIdFromName("velodyne"));
+  EXPECT_EQ(SENSOR_UNKNOWN, SensorIdFromName("unknown"));
+}